@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "combat_resolver.hpp"
+#include "combat_system.hpp"
+#include "fight_visitor.hpp"
+#include "movement_system.hpp"
+#include "npc.hpp"
+#include "npc_factory.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include "world.hpp"
+
+namespace {
+
+constexpr int kPairCount = 1024;
+
+std::vector<std::shared_ptr<lab7::NPC>> MakeFighters() {
+  std::vector<std::shared_ptr<lab7::NPC>> npcs;
+  for (int i = 0; i < kPairCount * 2; ++i) {
+    npcs.push_back(lab7::NpcFactory::CreateNPC(static_cast<lab7::NpcType>(i % 3 + 1),
+                                               "NPC" + std::to_string(i), 50, 50));
+  }
+  return npcs;
+}
+
+void BM_FightVisitor(benchmark::State& state) {
+  const auto npcs = MakeFighters();
+  int kills = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < kPairCount; ++i) {
+      auto visitor = std::dynamic_pointer_cast<lab7::FightVisitor>(npcs[2 * i]);
+      kills += visitor && npcs[2 * i + 1]->Accept(visitor);
+    }
+  }
+  benchmark::DoNotOptimize(kills);
+  state.SetItemsProcessed(state.iterations() * kPairCount);
+}
+BENCHMARK(BM_FightVisitor);
+
+void BM_FightTableNpc(benchmark::State& state) {
+  const auto npcs = MakeFighters();
+  int kills = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < kPairCount; ++i) {
+      kills += lab7::ResolveAttack(npcs[2 * i], npcs[2 * i + 1]);
+    }
+  }
+  benchmark::DoNotOptimize(kills);
+  state.SetItemsProcessed(state.iterations() * kPairCount);
+}
+BENCHMARK(BM_FightTableNpc);
+
+void BM_FightTableWorld(benchmark::State& state) {
+  lab7::World world;
+  world.SetSeed(42);
+  for (int i = 0; i < kPairCount * 2; ++i) {
+    world.Add(static_cast<lab7::NpcType>(i % 3 + 1), 50, 50);
+  }
+  const auto types = world.Types();
+  int kills = 0;
+
+  for (auto _ : state) {
+    for (lab7::EntityId a = 0; a < kPairCount * 2; a += 2) {
+      kills += lab7::ResolveAttack(types[a], types[a + 1], [&] { return world.RollDice(a); },
+                                   [&] { return world.RollDice(a + 1); });
+    }
+  }
+  benchmark::DoNotOptimize(kills);
+  state.SetItemsProcessed(state.iterations() * kPairCount);
+}
+BENCHMARK(BM_FightTableWorld);
+
+// One tick of encounters of 100k NPCs resolved in stripes on a pool,
+// compared with a plain sequential pass (threads:0).
+void BM_CombatBatches(benchmark::State& state) {
+  constexpr std::size_t kNpcCount = 100000;
+  const int map_size = static_cast<int>(std::sqrt(200.0 * kNpcCount));
+  lab7::World world;
+  lab7::ThreadPool pool(static_cast<std::size_t>(std::max<std::int64_t>(state.range(0), 1)));
+  lab7::MovementSystem movement(map_size);
+  movement.SetUniquePairs(true);
+  lab7::CombatSystem combat(map_size);
+  std::vector<lab7::CombatTask> tasks;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    world.Clear();
+    world.SetSeed(42);
+    for (std::size_t i = 0; i < kNpcCount; ++i) {
+      lab7::CounterRng rng(42, lab7::RngStream::Spawn, i, 0);
+      world.Add(static_cast<lab7::NpcType>(rng.NextInt(1, 3)), rng.NextInt(0, map_size),
+                rng.NextInt(0, map_size));
+    }
+    const auto& encounters = movement.Detect(world, 0, pool);
+    tasks.assign(encounters.begin(), encounters.end());
+    state.ResumeTiming();
+
+    if (state.range(0) == 0) {
+      for (const auto& task : tasks) {
+        benchmark::DoNotOptimize(lab7::CombatSystem::Resolve(world, task));
+      }
+    } else {
+      combat.ResolveBatches(world, tasks, pool);
+    }
+  }
+  state.counters["border_share"] =
+      static_cast<double>(combat.GetBorderCount()) / static_cast<double>(tasks.size());
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(tasks.size()));
+}
+BENCHMARK(BM_CombatBatches)->ArgName("threads")->Arg(0)->Arg(1)->Arg(2)->Arg(4)
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,84 @@
+#include <benchmark/benchmark.h>
+
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "distance_kernel.hpp"
+#include "npc.hpp"
+#include "npc_factory.hpp"
+#include "npc_types.hpp"
+
+namespace {
+
+constexpr std::size_t kCandidates = 4096;
+constexpr int kArea = 100;
+constexpr int kRadius = 25;
+
+struct Candidates {
+  std::vector<int> xs;
+  std::vector<int> ys;
+};
+
+Candidates MakeCandidates() {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> coord(0, kArea);
+  Candidates candidates;
+  for (std::size_t i = 0; i < kCandidates; ++i) {
+    candidates.xs.push_back(coord(gen));
+    candidates.ys.push_back(coord(gen));
+  }
+  return candidates;
+}
+
+// The per-pair test the object model does: one IsClose call per candidate.
+void BM_IsCloseLoop(benchmark::State& state) {
+  const auto candidates = MakeCandidates();
+  std::vector<std::shared_ptr<lab7::NPC>> npcs;
+  for (std::size_t i = 0; i < kCandidates; ++i) {
+    npcs.push_back(lab7::NpcFactory::CreateNPC(lab7::NpcType::Bear, "NPC" + std::to_string(i),
+                                               candidates.xs[i], candidates.ys[i]));
+  }
+  const auto attacker =
+      lab7::NpcFactory::CreateNPC(lab7::NpcType::Elf, "Attacker", kArea / 2, kArea / 2);
+
+  for (auto _ : state) {
+    std::size_t hits = 0;
+    for (const auto& npc : npcs) {
+      hits += attacker->IsClose(npc, kRadius);
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kCandidates));
+}
+BENCHMARK(BM_IsCloseLoop);
+
+// The same candidates as SoA columns in blocks of kDistanceBlock.
+// Arg: SimdLevel (0 scalar, 1 SSE2, 2 AVX2).
+void BM_WithinRadius(benchmark::State& state) {
+  const auto level = static_cast<lab7::SimdLevel>(state.range(0));
+  if (!lab7::IsSupported(level)) {
+    state.SkipWithError("not supported by this CPU");
+    return;
+  }
+  state.SetLabel(lab7::GetSimdLevelName(level));
+  const auto candidates = MakeCandidates();
+  const std::span<const int> xs(candidates.xs);
+  const std::span<const int> ys(candidates.ys);
+
+  for (auto _ : state) {
+    std::size_t hits = 0;
+    for (std::size_t block = 0; block < kCandidates; block += lab7::kDistanceBlock) {
+      hits += std::popcount(lab7::WithinRadius(level, xs.subspan(block, lab7::kDistanceBlock),
+                                               ys.subspan(block, lab7::kDistanceBlock),
+                                               kArea / 2, kArea / 2, kRadius));
+    }
+    benchmark::DoNotOptimize(hits);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kCandidates));
+}
+BENCHMARK(BM_WithinRadius)->ArgName("level")->Arg(0)->Arg(1)->Arg(2);
+
+}  // namespace
@@ -0,0 +1,187 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "batch_runner.hpp"
+#include "game.hpp"
+
+namespace {
+
+constexpr std::uint64_t kTicks = 100;
+// Same density as the default game: 50 NPCs on a 100x100 map.
+constexpr double kAreaPerNpc = 200.0;
+
+// Headless deterministic run: movement, detection and combat for kTicks
+// ticks on the default thread pool. Arg: NPC count.
+void BM_GameStep(benchmark::State& state) {
+  const int map_size = static_cast<int>(std::sqrt(kAreaPerNpc * state.range(0)));
+  lab7::Game game(std::thread::hardware_concurrency(), map_size);
+  game.SetHeadless(true);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    game.Initialize(static_cast<int>(state.range(0)), 42);
+    state.ResumeTiming();
+    game.Step(kTicks);
+  }
+  state.counters["ticks_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * kTicks), benchmark::Counter::kIsRate);
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kTicks) *
+                          state.range(0));
+}
+BENCHMARK(BM_GameStep)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+// Combat load with encounter matching off (-1) or with the given cooldown
+// in ticks, 10k NPCs. combat_tasks is per tick, what the workers resolve.
+void BM_GameStepCooldown(benchmark::State& state) {
+  constexpr int kNpcCount = 10000;
+  lab7::GameConfig config;
+  config.map_size = static_cast<int>(std::sqrt(kAreaPerNpc * kNpcCount));
+  config.headless = true;
+  if (state.range(0) < 0) {
+    config.combat_cooldown.reset();
+  } else {
+    config.combat_cooldown = static_cast<std::uint64_t>(state.range(0));
+  }
+  lab7::Game game(config);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    game.Initialize(kNpcCount, 42);
+    state.ResumeTiming();
+    game.Step(kTicks);
+  }
+  const lab7::MetricsSnapshot metrics = game.GetMetrics();
+  state.counters["combat_tasks"] =
+      static_cast<double>(metrics.Get(lab7::Counter::CombatTasks)) / kTicks;
+  state.counters["on_cooldown"] =
+      static_cast<double>(metrics.Get(lab7::Counter::EncountersOnCooldown)) / kTicks;
+  state.counters["kills"] = static_cast<double>(metrics.Get(lab7::Counter::Kills));
+}
+BENCHMARK(BM_GameStepCooldown)
+    ->ArgName("cooldown")
+    ->Arg(-1)
+    ->Arg(0)
+    ->Arg(5)
+    ->Arg(20)
+    ->Unit(benchmark::kMillisecond);
+
+// Reading positions of all live NPCs from the published frame.
+void BM_SnapshotScan(benchmark::State& state) {
+  lab7::Game game(1, 1000);
+  game.SetHeadless(true);
+  game.Initialize(static_cast<int>(state.range(0)), 42);
+
+  for (auto _ : state) {
+    const lab7::FrameView frame = game.GetSnapshot();
+    std::int64_t sum = 0;
+    for (const auto& entry : frame->Entries()) {
+      sum += entry.x + entry.y;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SnapshotScan)->Arg(10000);
+
+// The same through NPC handles, one shared_ptr per live entity.
+void BM_GetAliveNpcsScan(benchmark::State& state) {
+  lab7::Game game(1, 1000);
+  game.SetHeadless(true);
+  game.Initialize(static_cast<int>(state.range(0)), 42);
+
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    for (const auto& npc : game.GetAliveNPCs()) {
+      sum += npc->GetX() + npc->GetY();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GetAliveNpcsScan)->Arg(10000);
+
+// Monte Carlo batch of default-sized worlds (50 NPCs, 100x100) on a shared
+// pool, each run until no kill is possible or 1000 ticks. Arg: pool threads.
+void BM_BatchWorlds(benchmark::State& state) {
+  constexpr std::size_t kWorldCount = 256;
+  lab7::GameConfig config;
+  config.tick_budget = 1000;
+  config.thread_count = static_cast<std::size_t>(state.range(0));
+  lab7::BatchRunner runner(config, kWorldCount);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(runner.Run());
+  }
+  state.counters["worlds_per_second"] = benchmark::Counter(
+      static_cast<double>(state.iterations() * kWorldCount), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_BatchWorlds)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Threaded mode of several headless games sharing one scheduler, each with
+// an unlimited tick rate and a budget of kTicks ticks. Arg: scheduler
+// threads; 0 runs every game on the benchmark thread.
+void BM_GameRunShared(benchmark::State& state) {
+  constexpr int kGameCount = 8;
+  lab7::GameConfig config;
+  config.headless = true;
+  config.thread_count = 1;
+  config.tick_rate = lab7::GameConfig::kUnlimitedTickRate;
+  config.tick_budget = kTicks;
+  const auto scheduler = std::make_shared<lab7::Scheduler>(state.range(0));
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<std::unique_ptr<lab7::Game>> games;
+    for (int i = 0; i < kGameCount; ++i) {
+      games.push_back(std::make_unique<lab7::Game>(config, scheduler));
+      games.back()->Initialize(300, i + 1);
+    }
+    state.ResumeTiming();
+    for (auto& game : games) {
+      game->Start();
+    }
+    for (auto& game : games) {
+      game->Wait();
+    }
+  }
+  state.counters["ticks_per_second"] =
+      benchmark::Counter(static_cast<double>(state.iterations() * kGameCount * kTicks),
+                         benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_GameRunShared)->ArgName("workers")->Arg(0)->Arg(1)->Arg(4)->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+// Time from Stop() to the return of Run() for a game at the default tick
+// rate, stopped between ticks.
+void BM_GameStopLatency(benchmark::State& state) {
+  lab7::GameConfig config;
+  config.headless = true;
+  config.thread_count = 1;
+  config.duration = std::chrono::milliseconds::zero();
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    lab7::Game game(config);
+    game.Initialize(200, 42);
+    game.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    state.ResumeTiming();
+    game.Stop();
+    game.Wait();
+  }
+}
+BENCHMARK(BM_GameStopLatency)->Iterations(10)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+}  // namespace
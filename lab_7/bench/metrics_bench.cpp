@@ -0,0 +1,53 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "metrics.hpp"
+
+namespace {
+
+// Per-call cost of the recording paths used by Game, to compare against
+// BM_GameStep tick times.
+void BM_MetricsCounter(benchmark::State& state) {
+  lab7::MetricsRegistry registry;
+  lab7::MetricsShard& shard = registry.Local();
+
+  for (auto _ : state) {
+    shard.Add(lab7::Counter::Kills);
+  }
+  benchmark::DoNotOptimize(registry.Snapshot().Get(lab7::Counter::Kills));
+}
+BENCHMARK(BM_MetricsCounter);
+
+void BM_MetricsHistogram(benchmark::State& state) {
+  lab7::MetricsRegistry registry;
+  lab7::MetricsShard& shard = registry.Local();
+  std::uint64_t value = 1;
+
+  for (auto _ : state) {
+    shard.Record(lab7::Histogram::QueueDepth, value);
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+}
+BENCHMARK(BM_MetricsHistogram);
+
+void BM_MetricsScopedTimer(benchmark::State& state) {
+  lab7::MetricsRegistry registry;
+  lab7::MetricsShard& shard = registry.Local();
+
+  for (auto _ : state) {
+    lab7::ScopedTimer timer(shard, lab7::Histogram::MovementTickNs);
+  }
+}
+BENCHMARK(BM_MetricsScopedTimer);
+
+void BM_MetricsLocalLookup(benchmark::State& state) {
+  lab7::MetricsRegistry registry;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(&registry.Local());
+  }
+}
+BENCHMARK(BM_MetricsLocalLookup);
+
+}  // namespace
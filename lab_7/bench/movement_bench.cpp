@@ -0,0 +1,144 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "encounter_tracker.hpp"
+#include "movement_system.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+#include "world.hpp"
+
+namespace {
+
+constexpr double kAreaPerNpc = 100.0 * 100.0 / 50.0;
+constexpr std::size_t kNpcCount = 100000;
+
+int Populate(lab7::World& world, std::size_t count = kNpcCount, int map_size = 0) {
+  if (map_size == 0) {
+    map_size = static_cast<int>(std::sqrt(kAreaPerNpc * static_cast<double>(count)));
+  }
+  world.SetSeed(42);
+  world.Reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    lab7::CounterRng rng(42, lab7::RngStream::Spawn, i, 0);
+    world.Add(static_cast<lab7::NpcType>(rng.NextInt(1, 3)), rng.NextInt(0, map_size),
+              rng.NextInt(0, map_size));
+  }
+  return map_size;
+}
+
+// Movement alone, single-threaded; items are entity moves.
+void BM_MovementMove(benchmark::State& state) {
+  const auto count = static_cast<std::size_t>(state.range(0));
+  lab7::World world;
+  const int map_size = Populate(world, count);
+
+  lab7::ThreadPool pool(1);
+  lab7::MovementSystem movement(map_size);
+  std::uint64_t tick = 0;
+
+  for (auto _ : state) {
+    movement.Move(world, tick++, pool);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_MovementMove)->ArgName("npcs")->Arg(100000)->Arg(1000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Per-tick wall time of the movement and detection phase by thread count.
+void BM_MovementTick(benchmark::State& state) {
+  lab7::World world;
+  const int map_size = Populate(world);
+
+  lab7::ThreadPool pool(static_cast<std::size_t>(state.range(0)));
+  lab7::MovementSystem movement(map_size);
+  std::uint64_t tick = 0;
+  std::size_t encounters = 0;
+
+  for (auto _ : state) {
+    movement.Move(world, tick, pool);
+    encounters = movement.Detect(world, tick, pool).size();
+    ++tick;
+  }
+  state.counters["encounters"] = static_cast<double>(encounters);
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kNpcCount));
+}
+BENCHMARK(BM_MovementTick)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16)
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// Single-threaded tick after 90% of the population died, with the dead
+// still in the live list (compacted:0) or removed from it (compacted:1).
+void BM_MovementTickMostlyDead(benchmark::State& state) {
+  lab7::World world;
+  const int map_size = Populate(world);
+  for (lab7::EntityId id = 0; id < kNpcCount; ++id) {
+    if (id % 10 != 0) world.Kill(id);
+  }
+  if (state.range(0)) {
+    world.Compact();
+  }
+
+  lab7::ThreadPool pool(1);
+  lab7::MovementSystem movement(map_size);
+  std::uint64_t tick = 0;
+
+  for (auto _ : state) {
+    movement.Move(world, tick, pool);
+    benchmark::DoNotOptimize(movement.Detect(world, tick, pool).size());
+    ++tick;
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kNpcCount / 10));
+}
+BENCHMARK(BM_MovementTickMostlyDead)->ArgName("compacted")->Arg(0)->Arg(1)
+    ->Unit(benchmark::kMillisecond);
+
+// Single-threaded tick on a 10^6 x 10^6 map, which takes the sparse grid; a
+// dense grid of the same cells would need 40 GB.
+void BM_MovementTickLargeWorld(benchmark::State& state) {
+  const auto count = static_cast<std::size_t>(state.range(0));
+  lab7::World world;
+  const int map_size = Populate(world, count, 1000000);
+
+  lab7::ThreadPool pool(1);
+  lab7::MovementSystem movement(map_size);
+  movement.SetUniquePairs(true);
+  std::uint64_t tick = 0;
+  std::size_t encounters = 0;
+
+  for (auto _ : state) {
+    movement.Move(world, tick, pool);
+    encounters = movement.Detect(world, tick, pool).size();
+    ++tick;
+  }
+  state.counters["encounters"] = static_cast<double>(encounters);
+  state.counters["sparse"] = movement.IsSparse();
+  state.counters["grid_mb"] = static_cast<double>(movement.GetGridMemoryUsage()) / (1 << 20);
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(count));
+}
+BENCHMARK(BM_MovementTickLargeWorld)->ArgName("npcs")->Arg(1000000)->Arg(5000000)
+    ->Unit(benchmark::kMillisecond);
+
+// Cooldown filtering of one tick of unique-pair encounters (100k NPCs).
+void BM_EncounterFilter(benchmark::State& state) {
+  lab7::World world;
+  const int map_size = Populate(world);
+  lab7::ThreadPool pool(1);
+  lab7::MovementSystem movement(map_size);
+  movement.SetUniquePairs(true);
+  const std::vector<lab7::CombatTask> encounters = movement.Detect(world, 0, pool);
+
+  lab7::EncounterTracker tracker(static_cast<std::uint64_t>(state.range(0)));
+  std::uint64_t tick = 0;
+  std::size_t tasks = 0;
+  for (auto _ : state) {
+    tasks = tracker.Filter(encounters, tick++).size();
+  }
+  state.counters["encounters"] = static_cast<double>(encounters.size());
+  state.counters["tasks"] = static_cast<double>(tasks);
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(encounters.size()));
+}
+BENCHMARK(BM_EncounterFilter)->ArgName("cooldown")->Arg(1)->Arg(5)->Unit(benchmark::kMillisecond);
+
+}  // namespace
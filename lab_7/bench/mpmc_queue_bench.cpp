@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <queue>
+
+#include "mpmc_queue.hpp"
+
+namespace {
+
+constexpr std::size_t kCapacity = 512;
+constexpr std::size_t kBatch = 64;
+
+// Every thread is both a producer and a consumer of 64-item batches.
+void BM_MpmcQueueBatched(benchmark::State& state) {
+  static lab7::MpmcQueue<std::uint64_t> queue(kCapacity);
+  std::array<std::uint64_t, kBatch> batch{};
+  std::int64_t items = 0;
+
+  for (auto _ : state) {
+    items += static_cast<std::int64_t>(queue.PushBatch(batch));
+    items += static_cast<std::int64_t>(queue.PopBatch(batch));
+  }
+  state.SetItemsProcessed(items);
+}
+BENCHMARK(BM_MpmcQueueBatched)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_MutexQueue(benchmark::State& state) {
+  static std::mutex mutex;
+  static std::queue<std::uint64_t> queue;
+  std::int64_t items = 0;
+
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kBatch; ++i) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (queue.size() < kCapacity) {
+        queue.push(i);
+        ++items;
+      }
+    }
+    for (std::size_t i = 0; i < kBatch; ++i) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!queue.empty()) {
+        queue.pop();
+        ++items;
+      }
+    }
+  }
+  state.SetItemsProcessed(items);
+}
+BENCHMARK(BM_MutexQueue)->ThreadRange(1, 8)->UseRealTime();
+
+}  // namespace
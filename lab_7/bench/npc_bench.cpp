@@ -0,0 +1,169 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "event_bus.hpp"
+#include "npc.hpp"
+#include "npc_factory.hpp"
+#include "observer.hpp"
+#include "world.hpp"
+
+namespace {
+
+constexpr int kNpcCount = 1024;
+
+std::vector<std::shared_ptr<lab7::NPC>> MakeNpcs() {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> coord_dist(0, 100);
+  std::vector<std::shared_ptr<lab7::NPC>> npcs;
+  for (int i = 0; i < kNpcCount; ++i) {
+    npcs.push_back(lab7::NpcFactory::CreateNPC(static_cast<lab7::NpcType>(i % 3 + 1),
+                                               "NPC" + std::to_string(i), coord_dist(gen),
+                                               coord_dist(gen)));
+  }
+  return npcs;
+}
+
+class CountingObserver : public lab7::IFightObserver {
+ private:
+  std::uint64_t count_ = 0;
+
+ public:
+  void OnFight(const lab7::FightRecord&) override {
+    benchmark::DoNotOptimize(++count_);
+  }
+};
+
+void BM_NpcIsClose(benchmark::State& state) {
+  const auto npcs = MakeNpcs();
+  int close = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < kNpcCount; ++i) {
+      close += npcs[i]->IsClose(npcs[(i + 1) % kNpcCount], 10);
+    }
+  }
+  benchmark::DoNotOptimize(close);
+  state.SetItemsProcessed(state.iterations() * kNpcCount);
+}
+BENCHMARK(BM_NpcIsClose);
+
+void BM_NpcMove(benchmark::State& state) {
+  const auto npcs = MakeNpcs();
+  int step = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < kNpcCount; ++i) {
+      npcs[i]->Move(npcs[i]->GetX() + (step & 1 ? 1 : -1), npcs[i]->GetY());
+    }
+    ++step;
+  }
+  state.SetItemsProcessed(state.iterations() * kNpcCount);
+}
+BENCHMARK(BM_NpcMove);
+
+void BM_NpcRollDice(benchmark::State& state) {
+  const auto npcs = MakeNpcs();
+  int sum = 0;
+
+  for (auto _ : state) {
+    for (int i = 0; i < kNpcCount; ++i) {
+      sum += npcs[i]->RollDice();
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * kNpcCount);
+}
+BENCHMARK(BM_NpcRollDice);
+
+void BM_WorldRollDice(benchmark::State& state) {
+  lab7::World world;
+  world.SetSeed(42);
+  for (int i = 0; i < kNpcCount; ++i) {
+    world.Add(lab7::NpcType::Bear, 50, 50);
+  }
+  int sum = 0;
+
+  for (auto _ : state) {
+    for (lab7::EntityId id = 0; id < kNpcCount; ++id) {
+      sum += world.RollDice(id);
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations() * kNpcCount);
+}
+BENCHMARK(BM_WorldRollDice);
+
+constexpr int kFightBatch = 256;
+
+// One tick worth of kills spread over the map.
+std::vector<lab7::FightRecord> MakeFights() {
+  const auto npcs = MakeNpcs();
+  std::vector<lab7::FightRecord> fights;
+  for (int i = 0; i < kFightBatch; ++i) {
+    const auto& defender = npcs[(2 * i + 1) % kNpcCount];
+    lab7::FightRecord record{0, static_cast<lab7::EntityId>(2 * i),
+                             static_cast<lab7::EntityId>(2 * i + 1), npcs[2 * i]->GetType(),
+                             defender->GetType()};
+    record.x = defender->GetX();
+    record.y = defender->GetY();
+    fights.push_back(record);
+  }
+  return fights;
+}
+
+// Arg: number of subscribers that take every kill. The cost per fight does
+// not depend on how many NPCs there are, only on the subscribers.
+void BM_EventBusDispatch(benchmark::State& state) {
+  const auto fights = MakeFights();
+  lab7::FightEventBus bus;
+  for (int i = 0; i < state.range(0); ++i) {
+    bus.Subscribe(std::make_shared<CountingObserver>());
+  }
+
+  for (auto _ : state) {
+    bus.Dispatch(fights);
+  }
+  state.SetItemsProcessed(state.iterations() * kFightBatch * state.range(0));
+}
+BENCHMARK(BM_EventBusDispatch)->Arg(1)->Arg(4)->Arg(16);
+
+// Arg: number of subscribers, each watching a quarter of the map for one
+// type, so every batch is filtered per subscriber.
+void BM_EventBusDispatchFiltered(benchmark::State& state) {
+  const auto fights = MakeFights();
+  lab7::FightEventBus bus;
+  for (int i = 0; i < state.range(0); ++i) {
+    lab7::FightFilter filter;
+    filter.types = lab7::FightFilter::GetTypeBit(static_cast<lab7::NpcType>(i % 3 + 1));
+    filter.region = lab7::MapRegion{i % 2 * 50, i / 2 % 2 * 50, i % 2 * 50 + 49,
+                                    i / 2 % 2 * 50 + 49};
+    bus.Subscribe(std::make_shared<CountingObserver>(), filter);
+  }
+
+  for (auto _ : state) {
+    bus.Dispatch(fights);
+  }
+  state.SetItemsProcessed(state.iterations() * kFightBatch * state.range(0));
+}
+BENCHMARK(BM_EventBusDispatchFiltered)->Arg(1)->Arg(4)->Arg(16);
+
+// Real observer cost on the fight thread: formatting and I/O happen on the
+// log's writer thread.
+void BM_FightNotifyFileObserver(benchmark::State& state) {
+  const auto npcs = MakeNpcs();
+  auto observer = std::make_shared<lab7::FileObserver>("/dev/null");
+  lab7::FightRecord record{0, 0, 1, npcs[0]->GetType(), npcs[1]->GetType()};
+
+  for (auto _ : state) {
+    observer->OnFight(record);
+  }
+  observer->Flush();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FightNotifyFileObserver);
+
+}  // namespace
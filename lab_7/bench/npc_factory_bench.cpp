@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "npc.hpp"
+#include "npc_factory.hpp"
+#include "npc_pool.hpp"
+
+namespace {
+
+std::vector<std::string> MakeNames(std::size_t count) {
+  std::vector<std::string> names;
+  names.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    names.push_back("NPC" + std::to_string(i));
+  }
+  return names;
+}
+
+void BM_CreateNpcMakeShared(benchmark::State& state) {
+  const auto names = MakeNames(static_cast<std::size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    std::vector<std::shared_ptr<lab7::NPC>> npcs;
+    npcs.reserve(names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      npcs.push_back(lab7::NpcFactory::CreateNPC(static_cast<lab7::NpcType>(i % 3 + 1),
+                                                 names[i], 50, 50));
+    }
+    benchmark::DoNotOptimize(npcs.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateNpcMakeShared)->Arg(1000)->Arg(100000);
+
+// Includes the bulk teardown of the pool at the end of every iteration.
+void BM_CreateNpcPool(benchmark::State& state) {
+  const auto names = MakeNames(static_cast<std::size_t>(state.range(0)));
+  lab7::PoolStats stats;
+
+  for (auto _ : state) {
+    lab7::NpcPool pool(4096);
+    std::vector<std::shared_ptr<lab7::NPC>> npcs;
+    npcs.reserve(names.size());
+    for (std::size_t i = 0; i < names.size(); ++i) {
+      npcs.push_back(lab7::NpcFactory::CreateNPC(static_cast<lab7::NpcType>(i % 3 + 1),
+                                                 names[i], 50, 50, pool));
+    }
+    stats = pool.GetStats();
+    benchmark::DoNotOptimize(npcs.data());
+  }
+
+  if (stats.allocations != static_cast<std::uint64_t>(state.range(0))) {
+    state.SkipWithError("Pool allocation count does not match the number of NPCs");
+  }
+  state.counters["allocations"] = static_cast<double>(stats.allocations);
+  state.counters["slabs"] = static_cast<double>(stats.slabs);
+  state.counters["bytes_reserved"] = static_cast<double>(stats.bytes_reserved);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CreateNpcPool)->Arg(1000)->Arg(100000);
+
+}  // namespace
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "rng.hpp"
+
+namespace {
+
+constexpr std::size_t kEntityCount = 65536;
+
+// The standalone dice before: a thread_local mt19937 behind a distribution.
+void BM_Mt19937D6(benchmark::State& state) {
+  thread_local std::mt19937 gen(42);
+  thread_local std::uniform_int_distribution<> dice(1, 6);
+  int sum = 0;
+
+  for (auto _ : state) {
+    sum += dice(gen);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Mt19937D6);
+
+// One die per generator, the way World::RollDice draws.
+void BM_CounterRngD6(benchmark::State& state) {
+  std::uint32_t roll = 0;
+  int sum = 0;
+
+  for (auto _ : state) {
+    sum += lab7::CounterRng(42, lab7::RngStream::Dice, 7, roll++).NextInt(1, 6);
+  }
+  benchmark::DoNotOptimize(sum);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CounterRngD6);
+
+// One block per entity, as movement and spawning draw them.
+// Arg: SimdLevel (0 scalar, 2 AVX2).
+void BM_FillRandomBlocks(benchmark::State& state) {
+  const auto level = static_cast<lab7::SimdLevel>(state.range(0));
+  if (!lab7::IsSupported(level)) {
+    state.SkipWithError("not supported by this CPU");
+    return;
+  }
+  state.SetLabel(lab7::GetSimdLevelName(level));
+  std::vector<std::uint32_t> entities(kEntityCount);
+  std::iota(entities.begin(), entities.end(), 0U);
+  std::vector<lab7::RandomBlock> blocks(kEntityCount);
+  std::uint64_t tick = 0;
+
+  for (auto _ : state) {
+    lab7::FillRandomBlocks(level, 42, lab7::RngStream::Movement, entities, tick++, blocks);
+    benchmark::DoNotOptimize(blocks.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kEntityCount));
+}
+BENCHMARK(BM_FillRandomBlocks)->ArgName("level")->Arg(0)->Arg(2);
+
+}  // namespace
@@ -0,0 +1,250 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "fight_journal.hpp"
+#include "npc.hpp"
+#include "npc_factory.hpp"
+#include "npc_pool.hpp"
+#include "world.hpp"
+#include "world_snapshot.hpp"
+
+namespace {
+
+constexpr std::int64_t kNpcCount = 1'000'000;
+
+std::string TempPath(const std::string& name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<std::shared_ptr<lab7::NPC>> MakeNpcs(std::size_t count, lab7::NpcPool& pool) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> coord_dist(0, 100);
+  std::vector<std::shared_ptr<lab7::NPC>> npcs;
+  npcs.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    npcs.push_back(lab7::NpcFactory::CreateNPC(static_cast<lab7::NpcType>(i % 3 + 1),
+                                               "NPC" + std::to_string(i), coord_dist(gen),
+                                               coord_dist(gen), pool));
+  }
+  return npcs;
+}
+
+void SetBytesProcessed(benchmark::State& state, const std::string& path) {
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(std::filesystem::file_size(path)));
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_SaveText(benchmark::State& state) {
+  lab7::NpcPool pool(4096);
+  const auto npcs = MakeNpcs(static_cast<std::size_t>(state.range(0)), pool);
+  const auto path = TempPath("lab7_bench_text.txt");
+
+  for (auto _ : state) {
+    lab7::NpcFactory::SaveToFile(npcs, path);
+  }
+  SetBytesProcessed(state, path);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_SaveText)->Arg(kNpcCount)->Unit(benchmark::kMillisecond);
+
+void BM_SaveBinary(benchmark::State& state) {
+  lab7::NpcPool pool(4096);
+  const auto npcs = MakeNpcs(static_cast<std::size_t>(state.range(0)), pool);
+  const auto path = TempPath("lab7_bench_snapshot.bin");
+
+  for (auto _ : state) {
+    lab7::NpcFactory::SaveToBinaryFile(npcs, path);
+  }
+  SetBytesProcessed(state, path);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_SaveBinary)->Arg(kNpcCount)->Unit(benchmark::kMillisecond);
+
+void BM_LoadText(benchmark::State& state) {
+  const auto path = TempPath("lab7_bench_text.txt");
+  {
+    lab7::NpcPool pool(4096);
+    lab7::NpcFactory::SaveToFile(MakeNpcs(static_cast<std::size_t>(state.range(0)), pool), path);
+  }
+
+  for (auto _ : state) {
+    lab7::NpcPool pool(4096);
+    std::ifstream ifs(path);
+    const auto npcs = lab7::NpcFactory::LoadFromStream(ifs, pool);
+    if (npcs.size() != static_cast<std::size_t>(state.range(0))) {
+      state.SkipWithError("Loaded NPC count does not match");
+      break;
+    }
+  }
+  SetBytesProcessed(state, path);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_LoadText)->Arg(kNpcCount)->Unit(benchmark::kMillisecond);
+
+void BM_LoadBinary(benchmark::State& state) {
+  const auto path = TempPath("lab7_bench_snapshot.bin");
+  {
+    lab7::NpcPool pool(4096);
+    lab7::NpcFactory::SaveToBinaryFile(MakeNpcs(static_cast<std::size_t>(state.range(0)), pool),
+                                       path);
+  }
+
+  for (auto _ : state) {
+    lab7::NpcPool pool(4096);
+    const auto npcs = lab7::NpcFactory::LoadFromBinaryFile(path, pool);
+    if (npcs.size() != static_cast<std::size_t>(state.range(0))) {
+      state.SkipWithError("Loaded NPC count does not match");
+      break;
+    }
+  }
+  SetBytesProcessed(state, path);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_LoadBinary)->Arg(kNpcCount)->Unit(benchmark::kMillisecond);
+
+// Maps the snapshot and fills the packed world columns, without NPC objects.
+void BM_LoadBinaryWorld(benchmark::State& state) {
+  const auto path = TempPath("lab7_bench_snapshot.bin");
+  {
+    lab7::NpcPool pool(4096);
+    lab7::NpcFactory::SaveToBinaryFile(MakeNpcs(static_cast<std::size_t>(state.range(0)), pool),
+                                       path);
+  }
+
+  for (auto _ : state) {
+    lab7::World world;
+    lab7::WorldSnapshot(path).LoadInto(world);
+    if (world.Size() != static_cast<std::size_t>(state.range(0))) {
+      state.SkipWithError("Loaded entity count does not match");
+      break;
+    }
+  }
+  SetBytesProcessed(state, path);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_LoadBinaryWorld)->Arg(kNpcCount)->Unit(benchmark::kMillisecond);
+
+// Game-state checkpoints of a 1M-entity world: a full frame, and deltas
+// after `churn` entities moved. Deltas should cost what changed, not the
+// world size.
+void FillCheckpointWorld(lab7::World& world) {
+  world.Reserve(kNpcCount);
+  for (std::int64_t i = 0; i < kNpcCount; ++i) {
+    world.Add(static_cast<lab7::NpcType>(i % 3 + 1), static_cast<int>(i % 100),
+              static_cast<int>(i / 100 % 100));
+  }
+}
+
+void BM_CheckpointFull(benchmark::State& state) {
+  lab7::World world;
+  FillCheckpointWorld(world);
+  const auto path = TempPath("lab7_bench_checkpoint.bin");
+
+  for (auto _ : state) {
+    std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+    benchmark::DoNotOptimize(lab7::CheckpointFile::Write(ofs, world, {}, true));
+  }
+  SetBytesProcessed(state, path);
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_CheckpointFull)->Arg(kNpcCount)->Unit(benchmark::kMillisecond);
+
+void BM_CheckpointDelta(benchmark::State& state) {
+  lab7::World world;
+  FillCheckpointWorld(world);
+  const auto churn = static_cast<std::size_t>(state.range(0));
+  const auto path = TempPath("lab7_bench_checkpoint.bin");
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  lab7::CheckpointFile::Write(ofs, world, {}, true);
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<lab7::EntityId> id_dist(0, kNpcCount - 1);
+  int step = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    ++step;
+    for (std::size_t i = 0; i < churn; ++i) {
+      const lab7::EntityId id = id_dist(gen);
+      world.SetPosition(id, world.GetX(id), step);
+    }
+    ofs.seekp(0);
+    state.ResumeTiming();
+    benchmark::DoNotOptimize(lab7::CheckpointFile::Write(ofs, world, {}, false));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  ofs.close();
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_CheckpointDelta)->ArgName("churn")->Arg(1000)->Arg(10000)->Arg(100000)
+    ->Unit(benchmark::kMillisecond);
+
+// Fight journal: appending on the fight path (encoding and I/O happen a
+// block at a time), and a filtered scan of a mapped journal with 1M fights.
+lab7::FightRecord MakeFight(std::uint64_t i) {
+  const auto attacker = static_cast<lab7::EntityId>(i * 7919 % kNpcCount);
+  const auto defender = static_cast<lab7::EntityId>(i * 104729 % kNpcCount);
+  const auto outcome = static_cast<lab7::CombatOutcome>(i % 3 + 1);
+  return lab7::FightRecord{i / 1000,
+                           attacker,
+                           defender,
+                           static_cast<lab7::NpcType>(attacker % 3 + 1),
+                           static_cast<lab7::NpcType>(defender % 3 + 1),
+                           outcome,
+                           {static_cast<std::uint8_t>(i % 6 + 1), 3, 0, 0}};
+}
+
+void BM_JournalAppend(benchmark::State& state) {
+  lab7::World world;
+  FillCheckpointWorld(world);
+  const auto path = TempPath("lab7_bench_journal.bin");
+  std::uint64_t i = 0;
+  {
+    lab7::FightJournalWriter journal(path, world, 0);
+    for (auto _ : state) {
+      journal.Append(MakeFight(i++));
+    }
+  }
+  state.SetBytesProcessed(
+      static_cast<std::int64_t>(std::filesystem::file_size(path) - kNpcCount));
+  state.SetItemsProcessed(state.iterations());
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_JournalAppend);
+
+void BM_JournalQuery(benchmark::State& state) {
+  lab7::World world;
+  FillCheckpointWorld(world);
+  const auto path = TempPath("lab7_bench_journal.bin");
+  {
+    lab7::FightJournalWriter journal(path, world, 0);
+    for (std::uint64_t i = 0; i < static_cast<std::uint64_t>(kNpcCount); ++i) {
+      journal.Append(MakeFight(i));
+    }
+  }
+  lab7::JournalFilter filter;
+  filter.type = lab7::NpcType::Elf;
+  filter.kills_only = true;
+  filter.max_tick = static_cast<std::uint64_t>(state.range(0));
+
+  for (auto _ : state) {
+    std::uint64_t matches = 0;
+    lab7::FightJournal(path).ForEach(filter, [&](const lab7::FightRecord&) { ++matches; });
+    benchmark::DoNotOptimize(matches);
+  }
+  state.SetItemsProcessed(state.iterations() * std::min(state.range(0) * 1000, kNpcCount));
+  std::filesystem::remove(path);
+}
+BENCHMARK(BM_JournalQuery)->ArgName("to_tick")->Arg(100)->Arg(1000)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
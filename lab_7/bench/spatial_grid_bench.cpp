@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "distance_kernel.hpp"
+#include "npc.hpp"
+#include "npc_types.hpp"
+#include "sparse_grid.hpp"
+#include "spatial_grid.hpp"
+
+namespace {
+
+// Same density as the default game: 50 NPCs on a 100x100 map.
+constexpr double kAreaPerNpc = 100.0 * 100.0 / 50.0;
+constexpr int kCellSize = 10;
+// MovementSystem sizes sparse cells by the longest kill distance.
+constexpr int kSparseCellSize = 50;
+
+struct Population {
+  int map_size;
+  std::vector<int> xs;
+  std::vector<int> ys;
+  std::vector<int> kill_distances;
+};
+
+Population MakePopulation(std::size_t count, double area_per_npc = kAreaPerNpc) {
+  Population population;
+  population.map_size = static_cast<int>(std::sqrt(area_per_npc * count));
+
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> coord_dist(0, population.map_size);
+  std::uniform_int_distribution<> type_dist(1, 3);
+  for (std::size_t i = 0; i < count; ++i) {
+    population.xs.push_back(coord_dist(gen));
+    population.ys.push_back(coord_dist(gen));
+    population.kill_distances.push_back(
+        lab7::NpcStats::GetKillDistance(static_cast<lab7::NpcType>(type_dist(gen))));
+  }
+  return population;
+}
+
+template <typename Grid>
+void FindCombatPairs(benchmark::State& state, Grid& grid, const Population& population) {
+  std::size_t pairs = 0;
+
+  for (auto _ : state) {
+    pairs = 0;
+    grid.Build(population.xs, population.ys);
+    for (std::size_t i = 0; i < population.xs.size(); ++i) {
+      grid.ForEachInRadius(population.xs[i], population.ys[i],
+                           population.kill_distances[i], [&](std::size_t j) {
+                             pairs += (j != i);
+                           });
+    }
+    benchmark::DoNotOptimize(pairs);
+  }
+  state.counters["pairs"] = static_cast<double>(pairs);
+  state.counters["grid_kb"] = static_cast<double>(grid.GetMemoryUsage()) / 1024;
+  state.SetComplexityN(state.range(0));
+}
+
+void FindCombatPairsGrid(benchmark::State& state, double area_per_npc) {
+  const auto population =
+      MakePopulation(static_cast<std::size_t>(state.range(0)), area_per_npc);
+  lab7::SpatialGrid grid(population.map_size, kCellSize);
+  FindCombatPairs(state, grid, population);
+}
+
+void BM_FindCombatPairsGrid(benchmark::State& state) {
+  FindCombatPairsGrid(state, kAreaPerNpc);
+}
+BENCHMARK(BM_FindCombatPairsGrid)->RangeMultiplier(4)->Range(256, 262144)->Complexity(benchmark::oN);
+
+// 16 times the default density, where grid rows are long enough for the
+// vector distance kernel.
+void BM_FindCombatPairsGridDense(benchmark::State& state) {
+  FindCombatPairsGrid(state, kAreaPerNpc / 16);
+}
+BENCHMARK(BM_FindCombatPairsGridDense)->Arg(16384)->Arg(65536);
+
+// The sparse grid on the same populations as BM_FindCombatPairsGrid.
+void BM_FindCombatPairsSparseGrid(benchmark::State& state) {
+  const auto population = MakePopulation(static_cast<std::size_t>(state.range(0)));
+  lab7::SparseGrid grid(kSparseCellSize);
+  FindCombatPairs(state, grid, population);
+}
+BENCHMARK(BM_FindCombatPairsSparseGrid)->RangeMultiplier(4)->Range(256, 262144)
+    ->Complexity(benchmark::oN);
+
+void BM_FindCombatPairsBruteForce(benchmark::State& state) {
+  const auto population = MakePopulation(static_cast<std::size_t>(state.range(0)));
+  std::size_t pairs = 0;
+
+  for (auto _ : state) {
+    pairs = 0;
+    for (std::size_t i = 0; i < population.xs.size(); ++i) {
+      const std::int64_t radius = population.kill_distances[i];
+      for (std::size_t j = 0; j < population.xs.size(); ++j) {
+        const std::int64_t dx = population.xs[i] - population.xs[j];
+        const std::int64_t dy = population.ys[i] - population.ys[j];
+        pairs += (j != i && dx * dx + dy * dy <= radius * radius);
+      }
+    }
+    benchmark::DoNotOptimize(pairs);
+  }
+  state.counters["pairs"] = static_cast<double>(pairs);
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_FindCombatPairsBruteForce)->RangeMultiplier(4)->Range(256, 16384)->Complexity(benchmark::oNSquared);
+
+// The same scan with the batched distance kernel at the detected SIMD level.
+void BM_FindCombatPairsBruteForceKernel(benchmark::State& state) {
+  const auto population = MakePopulation(static_cast<std::size_t>(state.range(0)));
+  const std::span<const int> xs(population.xs);
+  const std::span<const int> ys(population.ys);
+  std::size_t pairs = 0;
+
+  for (auto _ : state) {
+    pairs = 0;
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      for (std::size_t block = 0; block < xs.size(); block += lab7::kDistanceBlock) {
+        const std::size_t count = std::min(lab7::kDistanceBlock, xs.size() - block);
+        std::uint64_t hits = lab7::WithinRadius(xs.subspan(block, count), ys.subspan(block, count),
+                                                xs[i], ys[i], population.kill_distances[i]);
+        if (i >= block && i < block + count) hits &= ~(std::uint64_t{1} << (i - block));
+        pairs += static_cast<std::size_t>(std::popcount(hits));
+      }
+    }
+    benchmark::DoNotOptimize(pairs);
+  }
+  state.counters["pairs"] = static_cast<double>(pairs);
+  state.SetLabel(lab7::GetSimdLevelName(lab7::GetSimdLevel()));
+  state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_FindCombatPairsBruteForceKernel)->RangeMultiplier(4)->Range(256, 16384)
+    ->Complexity(benchmark::oNSquared);
+
+// One query against consecutive runs of a given length, tested inline
+// (kernel:0) or with the distance kernel (kernel:1); kMinKernelRun sits
+// where the kernel starts to win. Candidates fill the query's bounding box,
+// as the cells a grid query visits do.
+void BM_ForEachInRun(benchmark::State& state) {
+  constexpr std::uint32_t kEntries = 1 << 16;
+  const auto run = static_cast<std::uint32_t>(state.range(0));
+  const std::uint32_t min_kernel_run = state.range(1) != 0 ? 0 : UINT32_MAX;
+  const auto population = MakePopulation(kEntries);
+  std::vector<std::uint32_t> index(kEntries);
+  std::iota(index.begin(), index.end(), 0U);
+  const int center = population.map_size / 2;
+  // Collected like detection collects pairs; a bare counter would let the
+  // inline loop vectorize, which no real caller does.
+  std::vector<std::size_t> hits;
+  hits.reserve(kEntries);
+  auto count_hit = [&](std::size_t j) { hits.push_back(j); };
+
+  for (auto _ : state) {
+    hits.clear();
+    for (std::uint32_t begin = 0; begin + run <= kEntries; begin += run) {
+      lab7::ForEachInRun(index, population.xs, population.ys, begin, begin + run, center, center,
+                         center, count_hit, min_kernel_run);
+    }
+  }
+  benchmark::DoNotOptimize(hits);
+  state.SetItemsProcessed(state.iterations() * kEntries);
+}
+BENCHMARK(BM_ForEachInRun)->ArgNames({"run", "kernel"})
+    ->ArgsProduct({{2, 4, 6, 8, 12, 16, 32}, {0, 1}});
+
+}  // namespace
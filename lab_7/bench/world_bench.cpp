@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "npc.hpp"
+#include "npc_factory.hpp"
+#include "world.hpp"
+
+namespace {
+
+void BM_ScanPositionsWorld(benchmark::State& state) {
+  const auto count = static_cast<std::size_t>(state.range(0));
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> coord_dist(0, 100);
+  lab7::World world;
+  world.Reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    world.Add(lab7::NpcType::Bear, coord_dist(gen), coord_dist(gen));
+  }
+
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    const auto xs = world.Xs();
+    const auto ys = world.Ys();
+    for (std::size_t i = 0; i < xs.size(); ++i) {
+      sum += xs[i] + ys[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ScanPositionsWorld)->Arg(1000)->Arg(100000);
+
+void BM_ScanPositionsNpcObjects(benchmark::State& state) {
+  const auto count = static_cast<std::size_t>(state.range(0));
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<> coord_dist(0, 100);
+  std::vector<std::shared_ptr<lab7::NPC>> npcs;
+  npcs.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    npcs.push_back(lab7::NpcFactory::CreateNPC(lab7::NpcType::Bear, "NPC" + std::to_string(i),
+                                               coord_dist(gen), coord_dist(gen)));
+  }
+
+  for (auto _ : state) {
+    std::int64_t sum = 0;
+    for (const auto& npc : npcs) {
+      sum += npc->GetX() + npc->GetY();
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ScanPositionsNpcObjects)->Arg(1000)->Arg(100000);
+
+}  // namespace
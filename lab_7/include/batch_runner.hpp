@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+
+#include "game_config.hpp"
+#include "npc_types.hpp"
+#include "thread_pool.hpp"
+
+namespace lab7 {
+
+// Count, sum and sum of squares of integer samples. Integer sums do not
+// depend on the order samples arrive in, so aggregates of a batch are the
+// same for any number of threads.
+struct Tally {
+  std::uint64_t count = 0;
+  std::uint64_t sum = 0;
+  std::uint64_t sum_sq = 0;
+  std::uint64_t min = UINT64_MAX;
+  std::uint64_t max = 0;
+
+  void Add(std::uint64_t value);
+  double GetMean() const;
+  double GetStddev() const;
+};
+
+using TypeCounts = std::array<std::uint64_t, NpcStats::kTypeCount>;
+// [winner type][loser type]
+using KillMatrix = std::array<TypeCounts, NpcStats::kTypeCount>;
+
+// Outcome of one world of a batch.
+struct WorldResult {
+  std::uint64_t seed = 0;
+  std::uint64_t ticks = 0;
+  TypeCounts initial{};
+  TypeCounts survivors{};
+  KillMatrix kills{};
+};
+
+// Distributions over the worlds of a batch, updated one world at a time.
+class BatchStats {
+ public:
+  static constexpr std::size_t kSurvivalBins = 10;
+
+  struct TypeSurvival {
+    Tally initial;
+    Tally survivors;
+    // Worlds where no NPC of the type survived, and where only it did.
+    std::uint64_t extinct = 0;
+    std::uint64_t wins = 0;
+    // Worlds by the surviving fraction of the type, in tenths; the last bin
+    // includes 100%. Worlds without the type are not counted.
+    std::array<std::uint64_t, kSurvivalBins> histogram{};
+  };
+
+ private:
+  std::uint64_t worlds_ = 0;
+  Tally ticks_;
+  std::array<TypeSurvival, NpcStats::kTypeCount> types_{};
+  std::array<std::array<Tally, NpcStats::kTypeCount>, NpcStats::kTypeCount> kills_{};
+
+ public:
+  void Add(const WorldResult& result);
+
+  std::uint64_t GetWorldCount() const;
+  const Tally& GetTicks() const;
+  const TypeSurvival& GetSurvival(NpcType type) const;
+  // Kills per world of the loser type by the winner type.
+  const Tally& GetKills(NpcType winner, NpcType loser) const;
+
+  void Print(std::ostream& os) const;
+};
+
+struct BatchReport {
+  BatchStats stats;
+  std::chrono::duration<double> elapsed{};
+
+  double GetWorldsPerSecond() const;
+};
+
+// Runs many independent seeded worlds on one shared thread pool, each in
+// the deterministic Step() mode on the thread that picked it up: no
+// dedicated game threads, sleeps or console output. World i uses seed
+// config.seed (default 1) + i; config.thread_count sizes the pool, while
+// every world itself is single-threaded. A world stops after
+// config.tick_budget ticks, or earlier once no alive pair of types can
+// kill each other; a zero budget runs each world until then.
+class BatchRunner {
+ public:
+  // Called under the runner's lock after every finished world, in the
+  // order worlds finish.
+  using Progress = std::function<void(const WorldResult& result, const BatchStats& stats)>;
+
+ private:
+  GameConfig config_;
+  std::size_t world_count_;
+  ThreadPool pool_;
+
+ public:
+  BatchRunner(const GameConfig& config, std::size_t world_count);
+
+  BatchReport Run(const Progress& on_world = {});
+
+  // Single world with the batch settings, on the calling thread.
+  static WorldResult RunWorld(const GameConfig& config, std::uint64_t seed);
+};
+
+}  // namespace lab7
@@ -7,7 +7,7 @@ namespace lab7 {
 
 class Bear : public NPC, public FightVisitor {
  public:
-  Bear(const std::string& name, int x, int y);
+  Bear(const std::string& name, int x, int y, MapBounds bounds = {});
 
   bool Accept(std::shared_ptr<FightVisitor> visitor) override;
 
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "encounter_tracker.hpp"
+#include "entity.hpp"
+
+namespace lab7 {
+
+class World;
+
+// A checkpoint file is a sequence of frames (little-endian, native
+// alignment), each one:
+//   CheckpointHeader
+//   CheckpointRecord[record_count]
+//   EntityId live[live_count], EntityId free[free_count]
+//   EncounterTracker::Entry[cooldown_count]
+//   string table: names of the records, addressed by offset and length
+// The first frame is full: a record per slot and both id lists. Later
+// frames are deltas holding the slots changed since the previous frame, and
+// the id lists only if they changed. The checksum covers the header up to
+// the checksum field and the frame payload.
+struct CheckpointHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t flags;
+  std::uint64_t tick;
+  std::uint64_t seed;
+  std::uint64_t slot_count;
+  std::uint64_t pending_dead;
+  std::uint64_t record_count;
+  std::uint64_t live_count;
+  std::uint64_t free_count;
+  std::uint64_t cooldown_count;
+  std::uint64_t string_table_size;
+  std::uint64_t checksum;
+};
+
+struct CheckpointRecord {
+  EntityId id;
+  std::int32_t x;
+  std::int32_t y;
+  std::uint32_t roll_count;
+  std::uint32_t generation;
+  // kGeneratedName when the entity has no stored name.
+  std::uint32_t name_offset;
+  std::uint32_t name_length;
+  NpcType type;
+  std::uint8_t alive;
+  std::uint8_t reserved[2];
+};
+
+static_assert(sizeof(CheckpointHeader) == 96);
+static_assert(sizeof(CheckpointRecord) == 32);
+
+// Simulation state kept outside the world.
+struct CheckpointState {
+  std::uint64_t tick = 0;
+  std::vector<EncounterTracker::Entry> cooldowns;
+};
+
+struct CheckpointInfo {
+  bool full;
+  std::size_t entities;
+  std::size_t bytes;
+};
+
+class CheckpointFile {
+ public:
+  static constexpr char kMagic[8] = {'L', 'A', 'B', '7', 'C', 'K', 'P', 'T'};
+  static constexpr std::uint32_t kVersion = 2;
+  static constexpr std::uint32_t kFullFrame = 1;
+  static constexpr std::uint32_t kHasLayout = 2;
+  static constexpr std::uint32_t kGeneratedName = UINT32_MAX;
+
+  // Appends a frame for the world's changed slots, or for all of them when
+  // full, and clears the world's change marks once it is written. Costs
+  // O(changed + slots / 64) for a delta.
+  static CheckpointInfo Write(std::ostream& os, World& world, const CheckpointState& state,
+                              bool full);
+  // Applies every frame of the stream in order to a cleared world and
+  // returns the state of the last one. The world's change marks are clear
+  // afterwards, so the next Write() may continue the chain with a delta.
+  static CheckpointState Read(std::istream& is, World& world);
+};
+
+}  // namespace lab7
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lab7 {
+
+// Word-at-a-time multiplicative hash of binary files; the tail is
+// zero-padded to a word. Pass the previous result as `hash` to chain
+// several buffers.
+std::uint64_t Checksum(const char* data, std::size_t size, std::uint64_t hash);
+
+}  // namespace lab7
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+
+#include "npc.hpp"
+#include "npc_types.hpp"
+
+namespace lab7 {
+
+// One attack resolved through NpcStats::kKillMatrix: a table lookup and, if
+// the attacker may kill the defender, two dice rolls. No virtual calls, RTTI
+// or reference counting. Rolls are drawn attacker first, as in the visitors.
+template <typename AttackRoll, typename DefenseRoll>
+bool ResolveAttack(NpcType attacker, NpcType defender, AttackRoll&& attack_roll,
+                   DefenseRoll&& defense_roll) {
+  if (!NpcStats::CanKill(attacker, defender)) {
+    return false;
+  }
+  const int attack = attack_roll();
+  const int defense = defense_roll();
+  return attack > defense;
+}
+
+// Same for NPC objects. Known types go through the table; anything else
+// falls back to the FightVisitor double dispatch.
+bool ResolveAttack(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender);
+
+}  // namespace lab7
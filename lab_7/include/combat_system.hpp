@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "fight_log.hpp"
+#include "movement_system.hpp"
+#include "world.hpp"
+
+namespace lab7 {
+
+class ThreadPool;
+
+struct FightResult {
+  CombatOutcome outcome;
+  // As in FightRecord.
+  std::array<std::uint8_t, 4> rolls;
+};
+
+// Combat phase of a tick. A task may only be resolved by whoever has both
+// of its entities to itself: Step() gets that by splitting the map into
+// vertical stripes whose fights cannot share an entity, the combat workers
+// by claiming the two entities in id order.
+class CombatSystem {
+ private:
+  struct StripeTask {
+    EntityId attacker;
+    EntityId defender;
+    std::uint32_t index;
+  };
+
+  int stripe_width_;
+  std::size_t stripe_count_;
+  std::vector<std::uint16_t> entity_stripe_;
+  // Per classification chunk: one list per stripe for pairs inside it, and
+  // indices of pairs crossing a stripe border.
+  std::vector<std::vector<std::vector<StripeTask>>> stripe_tasks_;
+  std::vector<std::vector<std::uint32_t>> border_tasks_;
+  std::vector<FightResult> results_;
+  std::size_t border_count_ = 0;
+
+  std::size_t GetStripe(int x) const;
+
+ public:
+  explicit CombatSystem(int map_size);
+
+  static bool IsKill(CombatOutcome outcome);
+  // Resolves a task whose entities nobody else is fighting.
+  static FightResult Resolve(World& world, const CombatTask& task);
+  static FightRecord MakeRecord(const World& world, const CombatTask& task,
+                                const FightResult& result);
+
+  // Safe to call from any number of threads at once. Claims the lower id
+  // first, backs off while either side is taken, and calls on_fight(record)
+  // for a fight that took place before releasing the claims.
+  template <typename OnFight>
+  static CombatOutcome ResolveClaimed(World& world, const CombatTask& task, OnFight&& on_fight);
+
+  // Resolves pairs inside each stripe on the pool, stripes in parallel and
+  // tasks of a stripe in their order, then pairs across stripe borders on
+  // the calling thread. Stripes depend only on the map size, so results do
+  // not depend on the number of threads. Positions must not change meanwhile.
+  void ResolveBatches(World& world, std::span<const CombatTask> tasks, ThreadPool& pool);
+  // Per task of the last ResolveBatches().
+  std::span<const FightResult> Results() const;
+  // Tasks of the last ResolveBatches() resolved serially at stripe borders.
+  std::size_t GetBorderCount() const;
+  std::size_t GetStripeCount() const;
+};
+
+template <typename OnFight>
+CombatOutcome CombatSystem::ResolveClaimed(World& world, const CombatTask& task,
+                                           OnFight&& on_fight) {
+  if (!world.IsAlive(task.attacker) || !world.IsAlive(task.defender)) {
+    return CombatOutcome::Skipped;
+  }
+
+  const EntityId first = std::min(task.attacker, task.defender);
+  const EntityId second = std::max(task.attacker, task.defender);
+  while (true) {
+    if (world.TryClaim(first)) {
+      if (world.TryClaim(second)) break;
+      world.Release(first);
+    }
+    std::this_thread::yield();
+  }
+
+  const FightResult result = Resolve(world, task);
+  if (result.outcome != CombatOutcome::Skipped) {
+    on_fight(MakeRecord(world, task, result));
+  }
+  world.Release(second);
+  world.Release(first);
+  return result.outcome;
+}
+
+}  // namespace lab7
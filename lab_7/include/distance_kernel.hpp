@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "simd.hpp"
+
+namespace lab7 {
+
+// Batched proximity test: one point against a block of SoA candidate
+// coordinates. The vector versions square 16-bit differences, so radii
+// above kMaxSimdRadius always take the scalar path.
+inline constexpr std::size_t kDistanceBlock = 64;
+inline constexpr int kMaxSimdRadius = 32766;
+
+// Bit k of the result is set if (xs[k], ys[k]) lies within radius of
+// (x, y). At most kDistanceBlock candidates; ys has as many as xs. The
+// first overload uses GetSimdLevel(), the second one a given supported level.
+std::uint64_t WithinRadius(std::span<const int> xs, std::span<const int> ys, int x, int y,
+                           int radius);
+std::uint64_t WithinRadius(SimdLevel level, std::span<const int> xs, std::span<const int> ys,
+                           int x, int y, int radius);
+
+}  // namespace lab7
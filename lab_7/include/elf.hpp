@@ -7,7 +7,7 @@ namespace lab7 {
 
 class Elf : public NPC, public FightVisitor {
  public:
-  Elf(const std::string& name, int x, int y);
+  Elf(const std::string& name, int x, int y, MapBounds bounds = {});
 
   bool Accept(std::shared_ptr<FightVisitor> visitor) override;
 
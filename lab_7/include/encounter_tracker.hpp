@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "movement_system.hpp"
+
+namespace lab7 {
+
+// Turns detected encounters into combat tasks: every unordered pair is kept
+// at most once per tick, and a pair that fought is not matched again for
+// `cooldown` ticks. The first task of a pair wins, so with sorted input the
+// lower id attacks when both are in each other's range.
+//
+// Pairs live in an open-addressing table stamped with the tick they last
+// fought; entries past their cooldown count as free and are dropped when
+// the table is rebuilt, so it is never cleared per tick.
+class EncounterTracker {
+ public:
+  // Unordered pair (lower id in the high half) and the tick it last fought.
+  struct Entry {
+    std::uint64_t pair;
+    std::uint64_t tick;
+  };
+
+ private:
+  static constexpr std::uint64_t kEmpty = UINT64_MAX;
+
+  std::uint64_t cooldown_;
+  std::vector<Entry> table_;
+  std::size_t used_ = 0;
+  std::vector<CombatTask> tasks_;
+
+  bool IsExpired(const Entry& entry, std::uint64_t tick) const;
+  // Returns true if the pair may fight at this tick and stamps it.
+  bool TryEngage(std::uint64_t pair, std::uint64_t tick);
+  void Rebuild(std::uint64_t tick, std::size_t incoming);
+  // Refills the table with `active`, sized for `incoming` more pairs.
+  void Assign(std::span<const Entry> active, std::size_t incoming);
+
+ public:
+  explicit EncounterTracker(std::uint64_t cooldown = 0);
+
+  const std::vector<CombatTask>& Filter(std::span<const CombatTask> encounters,
+                                        std::uint64_t tick);
+  void Clear();
+
+  // Pairs still on cooldown when `tick` is filtered; together with the
+  // cooldown they decide every later Filter() result, so checkpoints store
+  // them and Restore() rebuilds the table from them.
+  std::vector<Entry> GetActive(std::uint64_t tick) const;
+  void Restore(std::span<const Entry> entries);
+
+  std::uint64_t GetCooldown() const;
+  // Table slots in use, including pairs whose cooldown has run out.
+  std::size_t GetTrackedPairs() const;
+};
+
+}  // namespace lab7
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lab7 {
+
+// Slot of an entity in a World.
+using EntityId = std::uint32_t;
+
+enum class NpcType : std::uint8_t {
+  Unknown = 0,
+  Bear = 1,
+  Elf = 2,
+  Robber = 3
+};
+
+}  // namespace lab7
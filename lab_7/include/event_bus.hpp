@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "fight_log.hpp"
+#include "npc.hpp"
+
+namespace lab7 {
+
+class IFightObserver;
+
+// Inclusive rectangle of map cells.
+struct MapRegion {
+  int min_x;
+  int min_y;
+  int max_x;
+  int max_y;
+
+  bool Contains(int x, int y) const;
+};
+
+// Which fights a subscriber receives. Masks have a bit per enum value; the
+// type mask matches either side of a fight, the region the place of it.
+struct FightFilter {
+  static constexpr std::uint8_t kKills = (1U << static_cast<unsigned>(CombatOutcome::AttackerWon)) |
+                                         (1U << static_cast<unsigned>(CombatOutcome::DefenderWon));
+  static constexpr std::uint8_t kAllOutcomes = 0xFF;
+  static constexpr std::uint8_t kAllTypes = 0xFF;
+
+  std::uint8_t outcomes = kKills;
+  std::uint8_t types = kAllTypes;
+  std::optional<MapRegion> region;
+
+  static constexpr std::uint8_t GetOutcomeBit(CombatOutcome outcome) {
+    return static_cast<std::uint8_t>(1U << static_cast<unsigned>(outcome));
+  }
+  static constexpr std::uint8_t GetTypeBit(NpcType type) {
+    return static_cast<std::uint8_t>(1U << static_cast<unsigned>(type));
+  }
+
+  bool Matches(const FightRecord& record) const;
+  // True when every fight with an outcome in `outcomes` matches.
+  bool MatchesAll() const;
+};
+
+using SubscriptionId = std::uint64_t;
+
+// World-level fight event bus. Producers hand over the fights of a tick, or
+// of a combat batch, in one Dispatch(); each subscriber gets the matching
+// part of the batch in one OnFights() call, in batch order.
+//
+// Dispatch reads the subscriber list without locks: the list is immutable
+// and replaced as a whole (copy-on-write) by Subscribe(), Unsubscribe() and
+// Clear(), which are serialized by a mutex. A replaced list is freed by a
+// later update once no Dispatch() is running.
+class FightEventBus {
+ private:
+  struct Subscription {
+    SubscriptionId id;
+    std::shared_ptr<IFightObserver> observer;
+    FightFilter filter;
+  };
+
+  struct List {
+    std::vector<Subscription> subscriptions;
+    // Union of the outcome masks.
+    std::uint8_t outcomes = 0;
+  };
+
+  std::atomic<const List*> list_;
+  mutable std::atomic<std::uint32_t> dispatching_{0};
+  std::mutex update_mutex_;
+  std::vector<std::unique_ptr<const List>> retired_;
+  std::unique_ptr<const List> current_;
+  SubscriptionId next_id_ = 1;
+
+  void Replace(std::unique_ptr<List> list);
+
+ public:
+  FightEventBus();
+  ~FightEventBus();
+
+  FightEventBus(const FightEventBus&) = delete;
+  FightEventBus& operator=(const FightEventBus&) = delete;
+
+  SubscriptionId Subscribe(std::shared_ptr<IFightObserver> observer, FightFilter filter = {});
+  void Unsubscribe(SubscriptionId id);
+  void Clear();
+
+  // Outcomes some subscriber wants; producers may leave the others out of
+  // the batches they dispatch.
+  std::uint8_t GetOutcomeMask() const;
+  bool IsEmpty() const;
+
+  // Safe to call from any number of threads at once.
+  void Dispatch(std::span<const FightRecord> fights) const;
+  // Flushes every subscribed observer.
+  void Flush() const;
+};
+
+}  // namespace lab7
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "fight_log.hpp"
+#include "npc.hpp"
+
+namespace lab7 {
+
+class MappedFile;
+class World;
+
+// Append-only fight journal (little-endian, native alignment):
+//   JournalHeader
+//   roster: a byte per world slot at the start tick, type | alive << 7,
+//           zero-padded to a multiple of 8 bytes
+//   blocks: JournalBlockHeader, JournalRecord[record_count]
+//   JournalIndexEntry[block_count], JournalFooter
+// Blocks are written as they fill up; the index and footer only on Close(),
+// so a journal cut short still has every complete block and is read by
+// walking the blocks from the start. Each block checksum covers its records.
+// Every structure after the roster starts at a multiple of 8, so a mapped
+// journal is read in place.
+struct JournalHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t start_tick;
+  std::uint64_t seed;
+  std::uint64_t roster_size;
+};
+
+struct JournalBlockHeader {
+  // Ticks of the records are offsets from first_tick.
+  std::uint64_t first_tick;
+  std::uint64_t last_tick;
+  std::uint32_t record_count;
+  EntityId min_entity;
+  EntityId max_entity;
+  // Bit per NpcType of either side of a record.
+  std::uint8_t type_mask;
+  std::uint8_t reserved[3];
+  std::uint64_t checksum;
+};
+
+struct JournalRecord {
+  std::uint32_t tick_offset;
+  EntityId attacker;
+  EntityId defender;
+  // attacker type | defender type << 2 | outcome << 4
+  std::uint8_t kinds;
+  std::uint8_t reserved;
+  // FightRecord::rolls, three bits each, first roll lowest.
+  std::uint16_t rolls;
+};
+
+struct JournalIndexEntry {
+  std::uint64_t offset;
+  JournalBlockHeader block;
+};
+
+struct JournalFooter {
+  std::uint64_t index_offset;
+  std::uint64_t block_count;
+  char magic[8];
+};
+
+static_assert(sizeof(JournalHeader) == 40);
+static_assert(sizeof(JournalBlockHeader) == 40);
+static_assert(sizeof(JournalRecord) == 16);
+static_assert(sizeof(JournalIndexEntry) == 48);
+static_assert(sizeof(JournalFooter) == 24);
+static_assert(sizeof(JournalBlockHeader) % alignof(JournalIndexEntry) == 0 &&
+              sizeof(JournalRecord) % alignof(JournalIndexEntry) == 0);
+
+// Fights a query is interested in; empty fields match everything.
+struct JournalFilter {
+  std::uint64_t min_tick = 0;
+  std::uint64_t max_tick = UINT64_MAX;
+  std::optional<EntityId> entity;
+  // Either side of the fight.
+  std::optional<NpcType> type;
+  bool kills_only = false;
+
+  bool Matches(const FightRecord& record) const;
+  // False when no record of the block can match.
+  bool MayMatch(const JournalBlockHeader& block) const;
+};
+
+// Writes a journal for a world from its current tick on. Append() may be
+// called from any number of threads; records are kept in the order they
+// were appended.
+class FightJournalWriter {
+ private:
+  std::ofstream out_;
+  mutable std::mutex mutex_;
+  std::vector<FightRecord> pending_;
+  std::uint64_t pending_first_tick_ = 0;
+  std::uint64_t pending_last_tick_ = 0;
+  std::vector<JournalRecord> encoded_;
+  std::vector<JournalIndexEntry> index_;
+  std::size_t block_records_;
+  std::uint64_t offset_;
+  std::uint64_t record_count_ = 0;
+  bool closed_ = false;
+
+  void AppendLocked(const FightRecord& record);
+  void WriteBlock();
+
+ public:
+  static constexpr std::size_t kDefaultBlockRecords = 4096;
+
+  FightJournalWriter(const std::string& filename, const World& world, std::uint64_t start_tick,
+                     std::size_t block_records = kDefaultBlockRecords);
+  ~FightJournalWriter();
+
+  FightJournalWriter(const FightJournalWriter&) = delete;
+  FightJournalWriter& operator=(const FightJournalWriter&) = delete;
+
+  void Append(const FightRecord& record);
+  // Appends in order under one lock.
+  void Append(std::span<const FightRecord> records);
+  // Writes the records appended so far as a block.
+  void Flush();
+  // Flushes and writes the index; later appends are ignored.
+  void Close();
+
+  std::uint64_t GetRecordCount() const;
+};
+
+// Read-only view of a journal file mapped into memory (see MappedFile). Headers are checked
+// in the constructor, the checksum of a block whenever its records are read.
+class FightJournal {
+ private:
+  std::unique_ptr<MappedFile> file_;
+  const JournalHeader* header_;
+  std::span<const std::uint8_t> roster_;
+  std::vector<JournalIndexEntry> blocks_;
+  bool indexed_ = false;
+
+  void ScanBlocks(std::size_t end);
+
+ public:
+  static constexpr char kMagic[8] = {'L', 'A', 'B', '7', 'J', 'R', 'N', 'L'};
+  static constexpr char kFooterMagic[8] = {'L', 'A', 'B', '7', 'J', 'I', 'D', 'X'};
+  static constexpr std::uint32_t kVersion = 2;
+  static constexpr std::uint8_t kAliveBit = 0x80;
+
+  explicit FightJournal(const std::string& filename);
+  ~FightJournal();
+
+  FightJournal(const FightJournal&) = delete;
+  FightJournal& operator=(const FightJournal&) = delete;
+
+  static JournalRecord Encode(const FightRecord& record, std::uint64_t first_tick);
+  static FightRecord Decode(const JournalRecord& record, std::uint64_t first_tick);
+
+  std::uint64_t GetStartTick() const;
+  std::uint64_t GetSeed() const;
+  // False when the journal was not closed and its blocks were found by a scan.
+  bool IsIndexed() const;
+  std::span<const std::uint8_t> Roster() const;
+  std::span<const JournalIndexEntry> Blocks() const;
+  // Records of a block; throws std::runtime_error on a checksum mismatch.
+  std::span<const JournalRecord> Records(const JournalIndexEntry& entry) const;
+
+  // Calls fn(record) for every matching fight in journal order, skipping
+  // blocks the filter rules out without touching their records.
+  template <typename Fn>
+  void ForEach(const JournalFilter& filter, Fn&& fn) const;
+  // Liveness of every roster slot after the fights up to the given tick.
+  std::vector<bool> ReplayAlive(std::uint64_t tick) const;
+};
+
+template <typename Fn>
+void FightJournal::ForEach(const JournalFilter& filter, Fn&& fn) const {
+  for (const JournalIndexEntry& entry : blocks_) {
+    if (!filter.MayMatch(entry.block)) continue;
+    for (const JournalRecord& encoded : Records(entry)) {
+      const FightRecord record = Decode(encoded, entry.block.first_tick);
+      if (filter.Matches(record)) {
+        fn(record);
+      }
+    }
+  }
+}
+
+}  // namespace lab7
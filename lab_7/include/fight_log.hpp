@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "npc.hpp"
+
+namespace lab7 {
+
+enum class CombatOutcome : std::uint8_t {
+  Skipped,
+  NoWinner,
+  AttackerWon,
+  DefenderWon
+};
+
+// Compact record of a fight between the attacker and the defender of a
+// combat task. Rolls are the dice in the order they were thrown: attack and
+// defense of the attacker's try, then of the defender's; 0 where nobody
+// rolled. The fight takes place at the defender's position.
+struct FightRecord {
+  std::uint64_t tick;
+  EntityId attacker;
+  EntityId defender;
+  NpcType attacker_type;
+  NpcType defender_type;
+  CombatOutcome outcome = CombatOutcome::AttackerWon;
+  std::array<std::uint8_t, 4> rolls{};
+  std::int32_t x = 0;
+  std::int32_t y = 0;
+};
+
+using NameLookup = std::function<std::string(EntityId)>;
+
+// Asynchronous fight log. Each producing thread appends records to its own
+// lock-free single-producer list of fixed-size blocks; a background writer
+// drains all of them every flush interval (or earlier, once a thread has
+// filled a block), formats the records and writes them in one batch.
+// Pushing never waits for I/O. Records are only dropped, and counted, when
+// a thread has kMaxPendingBlocks blocks waiting for the writer.
+class AsyncFightLog {
+ private:
+  static constexpr std::size_t kBlockSize = 512;
+  static constexpr std::size_t kMaxPendingBlocks = 1024;
+
+  struct Block {
+    std::array<FightRecord, kBlockSize> records;
+    std::atomic<std::size_t> count{0};
+    std::atomic<Block*> next{nullptr};
+  };
+
+  struct Stream {
+    Block* head;
+    std::size_t consumed = 0;
+    Block* tail;
+    std::atomic<std::size_t> pending_blocks{1};
+
+    Stream();
+    ~Stream();
+  };
+
+  std::ostream& out_;
+  std::mutex* out_mutex_;
+  NameLookup names_;
+  std::chrono::milliseconds flush_interval_;
+  std::uint64_t id_;
+
+  std::mutex streams_mutex_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+  std::vector<std::string> lines_;
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  std::condition_variable flushed_cv_;
+  // Blocks filled since the writer last woke up; any wakes it early.
+  std::atomic<std::size_t> full_blocks_{0};
+  bool stop_;
+  std::uint64_t flush_requests_;
+  std::uint64_t flushes_done_;
+
+  std::atomic<std::uint64_t> written_;
+  std::atomic<std::uint64_t> dropped_;
+  std::thread writer_;
+
+  Stream& LocalStream();
+  void Push(Stream& stream, const FightRecord& record);
+  void WriterLoop();
+  void Drain(std::string& buffer);
+  void Format(const FightRecord& record, std::string& buffer) const;
+
+ public:
+  AsyncFightLog(std::ostream& out, NameLookup names, std::chrono::milliseconds flush_interval,
+                std::mutex* out_mutex = nullptr);
+  ~AsyncFightLog();
+
+  AsyncFightLog(const AsyncFightLog&) = delete;
+  AsyncFightLog& operator=(const AsyncFightLog&) = delete;
+
+  void Push(const FightRecord& record);
+  void Push(std::span<const FightRecord> records);
+  // Slow path for lines formatted by the caller.
+  void PushLine(std::string line);
+  // Blocks until everything pushed before the call is written.
+  void Flush();
+
+  std::uint64_t GetWritten() const;
+  std::uint64_t GetDropped() const;
+};
+
+}  // namespace lab7
@@ -1,51 +1,166 @@
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
+#include <cstdint>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <ostream>
 #include <shared_mutex>
+#include <span>
+#include <string>
+#include <thread>
 #include <vector>
 
+#include "checkpoint.hpp"
+#include "combat_system.hpp"
+#include "encounter_tracker.hpp"
+#include "event_bus.hpp"
+#include "fight_journal.hpp"
+#include "fight_log.hpp"
+#include "game_config.hpp"
+#include "metrics.hpp"
+#include "movement_system.hpp"
+#include "mpmc_queue.hpp"
 #include "npc.hpp"
+#include "npc_pool.hpp"
+#include "scheduler.hpp"
+#include "thread_pool.hpp"
+#include "world.hpp"
+#include "world_frame.hpp"
 
 namespace lab7 {
 
-struct CombatTask {
-  std::shared_ptr<NPC> attacker;
-  std::shared_ptr<NPC> defender;
-};
-
 class Game {
  private:
-  std::vector<std::shared_ptr<NPC>> npcs_;
-  mutable std::shared_mutex npcs_mutex_;
+  World world_;
+  mutable std::shared_mutex world_mutex_;
+  FightEventBus events_;
+  mutable NpcPool handle_pool_;
   
-  std::queue<CombatTask> combat_queue_;
-  std::mutex combat_queue_mutex_;
-  std::condition_variable combat_queue_cv_;
+  MpmcQueue<CombatTask> combat_queue_;
   
   std::atomic<bool> running_;
+  std::atomic<std::uint64_t> tick_;
   mutable std::mutex cout_mutex_;
+  std::shared_ptr<Scheduler> scheduler_;
+  // Set by Stop(); every stage waits on it along with whatever else it waits for.
+  AsyncEvent stop_event_;
+  // Set when tasks are pushed to the combat queue.
+  AsyncEvent combat_ready_;
+  TaskGroup stages_;
+  bool started_ = false;
+  GameConfig config_;
+  
+  mutable MetricsRegistry metrics_;
+  FrameBuffer frames_;
+  
+  static constexpr size_t kCombatQueueCapacity = 512;
+  static constexpr size_t kCombatBatchSize = 64;
+  
+  // Stages of the threaded mode, run as coroutines on the scheduler. None
+  // holds a lock across a suspension point.
+  Task MovementStage();
+  Task CombatStage();
+  Task RenderStage();
+  Task TimerStage();
+  void ResolveCombatBatch(std::span<const CombatTask> tasks, std::vector<FightRecord>& fights);
+  
+  ThreadPool pool_;
+  MovementSystem movement_;
+  EncounterTracker encounters_;
+  CombatSystem combat_;
+  // File the last checkpoint went to; later ones append deltas to it.
+  std::string checkpoint_path_;
+  std::unique_ptr<FightJournalWriter> journal_;
+  // Fights of the current tick in Step(), dispatched together.
+  std::vector<FightRecord> tick_fights_;
   
-  static constexpr int MAP_SIZE = 100;
-  static constexpr int GAME_DURATION_SECONDS = 30;
+  void Reset(std::uint64_t seed, size_t capacity);
+  // Starts the configured journal at the current tick of a populated world.
+  void OpenJournal();
   
-  void MovementThread();
-  void CombatThread();
-  void MainThread();
+  // Drops dead entities from the live list once enough have piled up.
+  // Takes the world lock exclusively, so call it without holding it.
+  void CompactWorld(MetricsShard& metrics);
+  // Movement and detection of one tick, shared by the threaded mode and
+  // Step(). Only one driver may run it at a time, under a shared world lock.
+  const std::vector<CombatTask>& AdvanceTick(MetricsShard& metrics);
+  void DumpMetrics() const;
+  void PublishFrame(MetricsShard& metrics);
+  
+  std::shared_ptr<NPC> MakeHandle(EntityId id) const;
+  // Fights worth a record: everything for the journal, otherwise what
+  // some subscriber wants.
+  std::uint8_t GetRecordedOutcomes() const;
+  void PublishFights(std::span<const FightRecord> fights) const;
+  void PrintEntity(std::ostream& os, EntityId id) const;
   
  public:
-  Game();
+  explicit Game(size_t thread_count = std::thread::hardware_concurrency(),
+                int map_size = GameConfig::kDefaultMapSize);
+  // Runs the stages on a scheduler of config.worker_threads threads.
+  explicit Game(const GameConfig& config);
+  // Runs the stages on a scheduler that other games may share.
+  Game(const GameConfig& config, std::shared_ptr<Scheduler> scheduler);
   ~Game();
   
+  const GameConfig& GetConfig() const;
+  // Headless games log no fights; takes effect on the next Initialize().
+  void SetHeadless(bool headless);
+  // Subscribes to the fights the filter matches, kills by default, until
+  // the next Initialize(), LoadRecording() or Restore(), which start over
+  // with the default observers. Fights come in one batch per tick in
+  // Step() and per combat batch in Run().
+  SubscriptionId Subscribe(std::shared_ptr<IFightObserver> observer, FightFilter filter = {});
+  void Unsubscribe(SubscriptionId id);
+  
   void Initialize(int npc_count = 50);
+  void Initialize(int npc_count, std::uint64_t seed);
+  // Threaded mode: movement, combat, render and timer stages run until the
+  // duration or tick budget runs out or Stop() is called. Run() is Start()
+  // followed by Wait(); several games on one scheduler can be started
+  // first and waited for in any order, as waiting helps run all of them.
   void Run();
+  void Start();
+  // Returns once every stage finished, rethrowing the first exception.
+  void Wait();
+  // Safe from any thread; waiting stages wake up at once.
   void Stop();
   
+  // Deterministic mode: advances the simulation by the given number of
+  // ticks on the calling thread, without sleeping.
+  void Step(std::uint64_t ticks = 1);
+  std::uint64_t GetTick() const;
+  std::uint64_t GetSeed() const;
+  QueueStats GetCombatQueueStats() const;
+  
+  MetricsSnapshot GetMetrics() const;
+  // Rewrites the file with a fresh snapshot every rendered frame and at the
+  // end of Run().
+  void SetMetricsDump(const std::string& filename, MetricsFormat format);
+  // Journals every fight, not only kills, to a file; takes effect on the
+  // next Initialize(), LoadRecording() or Restore(). Empty turns it off.
+  void SetJournal(const std::string& filename);
+  
+  void SaveRecording(const std::string& filename, std::uint64_t ticks) const;
+  std::uint64_t LoadRecording(const std::string& filename);
+  
+  // Saves the full simulation state at the current tick boundary: world
+  // slots with dice counts, live and free lists, tick and combat cooldowns.
+  // The first checkpoint to a file is full; later ones to the same file
+  // append a delta with only the entities changed since the previous one.
+  // Not allowed while Run() is active, as combat tasks may be in flight.
+  CheckpointInfo Checkpoint(const std::string& filename);
+  // Continues from the last frame of a checkpoint file; the next
+  // Checkpoint() to the same file appends to it.
+  void Restore(const std::string& filename);
+  
+  // Frame published at the end of the latest tick; reading it takes no
+  // locks and does not slow the simulation threads down.
+  FrameView GetSnapshot() const;
   std::vector<std::shared_ptr<NPC>> GetAliveNPCs() const;
   void PrintMap() const;
+  void PrintSurvivors() const;
 };
 
 }  // namespace lab7
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "map_bounds.hpp"
+#include "metrics.hpp"
+
+namespace lab7 {
+
+// Settings of a game run. Options use the same names on the command line
+// (--map-size=200 or --map-size 200) and in a config file (map-size = 200,
+// one per line, # starts a comment).
+struct GameConfig {
+  static constexpr int kDefaultMapSize = MapBounds::kDefaultSize;
+  static constexpr int kDefaultNpcCount = 50;
+  static constexpr int kDefaultTickRate = 10;
+  static constexpr int kUnlimitedTickRate = 0;
+  static constexpr std::size_t kDefaultCombatThreads = 2;
+  static constexpr std::size_t kDefaultWorkerThreads = 2;
+
+  // Both coordinates lie in [0, map_size]; at most MapBounds::kMaxSize.
+  int map_size = kDefaultMapSize;
+  int npc_count = kDefaultNpcCount;
+  // Stop after this many ticks; 0 means no tick limit.
+  std::uint64_t tick_budget = 0;
+  // Wall-clock limit; zero means no limit.
+  std::chrono::milliseconds duration{30000};
+  // Movement ticks per second; kUnlimitedTickRate means no sleeping.
+  int tick_rate = kDefaultTickRate;
+  std::chrono::milliseconds render_interval{1000};
+  // Ticks a pair that fought waits before it can be matched again; 0 still
+  // matches every pair at most once per tick. No value turns matching off
+  // and sends every detected encounter to combat.
+  std::optional<std::uint64_t> combat_cooldown = 0;
+  // No map, survivor or fight output.
+  bool headless = false;
+  std::size_t thread_count = std::thread::hardware_concurrency();
+  // Coroutines resolving queued fights in the threaded mode.
+  std::size_t combat_threads = kDefaultCombatThreads;
+  // Scheduler threads running the stages of the threaded mode; 0 runs them
+  // on the thread that calls Run().
+  std::size_t worker_threads = kDefaultWorkerThreads;
+  std::optional<std::uint64_t> seed;
+  std::string metrics_file;
+  MetricsFormat metrics_format = MetricsFormat::Json;
+  // Binary journal of every fight, written from the start of a game.
+  std::string journal_file;
+
+  // Throws std::invalid_argument for unknown options or bad values.
+  void Set(std::string_view key, std::string_view value);
+  void LoadFromStream(std::istream& is);
+  void LoadFromFile(const std::string& filename);
+  // Parses --option[=value] arguments starting at argv[first];
+  // --config=<file> loads a file in place.
+  void ParseArgs(int argc, char* argv[], int first = 1);
+
+  MapBounds GetBounds() const;
+
+  static std::string_view GetHelp();
+};
+
+}  // namespace lab7
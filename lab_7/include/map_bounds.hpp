@@ -0,0 +1,25 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace lab7 {
+
+// Square map with both coordinates in [0, size]. Coordinates are int32 and
+// the size is capped so that a coordinate plus any kill distance, and the
+// difference of two coordinates, still fit; squared distances are int64.
+struct MapBounds {
+  static constexpr std::int32_t kDefaultSize = 100;
+  static constexpr std::int32_t kMaxSize = 1 << 30;
+
+  std::int32_t size = kDefaultSize;
+
+  std::int32_t Clamp(std::int64_t value) const {
+    return static_cast<std::int32_t>(std::clamp<std::int64_t>(value, 0, size));
+  }
+  bool Contains(std::int64_t x, std::int64_t y) const {
+    return x >= 0 && x <= size && y >= 0 && y <= size;
+  }
+};
+
+}  // namespace lab7
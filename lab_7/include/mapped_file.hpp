@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace lab7 {
+
+// Read-only contents of a whole file. POSIX builds map the file into
+// memory; other platforms read it into a heap buffer. Either way the data
+// is aligned for any fundamental type.
+class MappedFile {
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+  // Owns the data when the file is read instead of mapped.
+  std::unique_ptr<std::max_align_t[]> buffer_;
+
+ public:
+  // Throws std::runtime_error if the file cannot be opened or read.
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const char* Data() const;
+  std::size_t Size() const;
+  // Hints that the data will be read front to back.
+  void AdviseSequential() const;
+};
+
+}  // namespace lab7
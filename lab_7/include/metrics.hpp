@@ -0,0 +1,149 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "mpmc_queue.hpp"
+
+namespace lab7 {
+
+enum class Counter : std::uint8_t {
+  Ticks,
+  EntityUpdates,
+  CombatTasks,
+  EncountersOnCooldown,
+  TasksDropped,
+  Kills,
+  NoWinner,
+  CombatSkipped,
+  EntitiesCompacted,
+  Frames,
+  FramesSkipped,
+  kCount
+};
+
+enum class Histogram : std::uint8_t {
+  MovementTickNs,
+  CombatBatchNs,
+  RenderNs,
+  QueueDepth,
+  kCount
+};
+
+enum class MetricsFormat {
+  Json,
+  Prometheus
+};
+
+std::string_view GetCounterName(Counter counter);
+std::string_view GetHistogramName(Histogram histogram);
+
+// Log-linear buckets in the spirit of HdrHistogram: values below
+// kSubBuckets are exact, larger ones keep 4 significant bits (~6% error).
+struct HistogramBuckets {
+  static constexpr int kSubBucketBits = 4;
+  static constexpr std::uint64_t kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kMaxValueBits = 40;
+  static constexpr std::uint64_t kMaxValue = (std::uint64_t{1} << kMaxValueBits) - 1;
+  static constexpr std::size_t kCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+  static std::size_t IndexOf(std::uint64_t value);
+  // Largest value that falls into the bucket.
+  static std::uint64_t UpperBound(std::size_t index);
+};
+
+struct HistogramSnapshot {
+  std::uint64_t count = 0;
+  std::uint64_t sum = 0;
+  std::uint64_t min = 0;
+  std::uint64_t max = 0;
+  std::vector<std::uint64_t> buckets;
+
+  // Value at the quantile q in [0, 1], within bucket precision.
+  std::uint64_t Percentile(double q) const;
+};
+
+struct MetricsSnapshot {
+  std::array<std::uint64_t, static_cast<std::size_t>(Counter::kCount)> counters{};
+  std::array<HistogramSnapshot, static_cast<std::size_t>(Histogram::kCount)> histograms;
+  QueueStats combat_queue;
+
+  std::uint64_t Get(Counter counter) const;
+  const HistogramSnapshot& Get(Histogram histogram) const;
+};
+
+void WriteMetrics(const MetricsSnapshot& snapshot, MetricsFormat format, std::ostream& os);
+// Writes to a temporary file first, so readers never see a partial dump.
+void WriteMetricsFile(const MetricsSnapshot& snapshot, MetricsFormat format,
+                      const std::string& filename);
+
+// Metrics written by one thread only; other threads just read them.
+class MetricsShard {
+ private:
+  struct HistogramData {
+    std::array<std::atomic<std::uint64_t>, HistogramBuckets::kCount> buckets{};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> min{UINT64_MAX};
+    std::atomic<std::uint64_t> max{0};
+  };
+
+  std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::kCount)> counters_{};
+  std::array<HistogramData, static_cast<std::size_t>(Histogram::kCount)> histograms_;
+
+  friend class MetricsRegistry;
+
+ public:
+  void Add(Counter counter, std::uint64_t value = 1);
+  void Record(Histogram histogram, std::uint64_t value);
+  void Record(Histogram histogram, std::chrono::steady_clock::duration duration);
+};
+
+// Registry of per-thread shards. Recording touches only the calling
+// thread's shard with relaxed loads and stores; Snapshot() merges them.
+class MetricsRegistry {
+ private:
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<MetricsShard>> shards_;
+  std::uint64_t id_;
+
+ public:
+  MetricsRegistry();
+
+  MetricsRegistry(const MetricsRegistry&) = delete;
+  MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+  // Shard of the calling thread.
+  MetricsShard& Local();
+  MetricsSnapshot Snapshot() const;
+  // Number of threads that have recorded so far.
+  std::size_t GetShardCount() const;
+  // Only valid while no thread is recording.
+  void Reset();
+};
+
+// Records the time from construction to destruction.
+class ScopedTimer {
+ private:
+  MetricsShard& shard_;
+  Histogram histogram_;
+  std::chrono::steady_clock::time_point start_;
+
+ public:
+  ScopedTimer(MetricsShard& shard, Histogram histogram);
+  ~ScopedTimer();
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+}  // namespace lab7
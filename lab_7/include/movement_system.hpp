@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include "rng.hpp"
+#include "sparse_grid.hpp"
+#include "spatial_grid.hpp"
+#include "world.hpp"
+
+namespace lab7 {
+
+class ThreadPool;
+
+struct CombatTask {
+  EntityId attacker;
+  EntityId defender;
+  std::uint64_t tick;
+};
+
+// Movement and proximity detection phase of a tick. Both stages are split
+// into index ranges run on a thread pool; detection queries one grid built
+// over the whole map, so pairs across range borders are found like any other.
+// Maps whose dense grid would be too large get a SparseGrid instead.
+class MovementSystem {
+ private:
+  int map_size_;
+  std::variant<SpatialGrid, SparseGrid> grid_;
+  std::vector<std::uint32_t> move_groups_;
+  std::vector<RandomBlock> move_blocks_;
+  std::vector<int> move_xs_;
+  std::vector<int> move_ys_;
+  std::vector<EntityId> alive_ids_;
+  std::vector<int> xs_;
+  std::vector<int> ys_;
+  std::vector<std::vector<CombatTask>> chunk_encounters_;
+  std::vector<CombatTask> encounters_;
+  bool unique_pairs_ = false;
+
+  // Encounters of alive entities [begin, end) of the last collection.
+  template <typename Grid>
+  void DetectRange(const Grid& grid, std::span<const NpcType> types, std::uint64_t tick,
+                   std::size_t begin, std::size_t end, std::vector<CombatTask>& out) const;
+
+ public:
+  explicit MovementSystem(int map_size);
+
+  // With unique pairs Detect() reports each close pair once instead of in
+  // both directions: if both are within kill range, the one earlier in
+  // World::LiveIds() attacks.
+  void SetUniquePairs(bool unique_pairs);
+
+  void Move(World& world, std::uint64_t tick, ThreadPool& pool);
+  // Returns encounters of live entities sorted by (attacker, defender).
+  const std::vector<CombatTask>& Detect(const World& world, std::uint64_t tick, ThreadPool& pool);
+  // Live entities seen by the last Detect().
+  std::size_t GetAliveCount() const;
+  bool IsSparse() const;
+  // Bytes held by the detection grid.
+  std::size_t GetGridMemoryUsage() const;
+};
+
+}  // namespace lab7
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+
+namespace lab7 {
+
+struct QueueStats {
+  std::uint64_t enqueued = 0;
+  std::uint64_t dequeued = 0;
+  std::uint64_t dropped = 0;
+  std::uint64_t high_water = 0;
+};
+
+// Bounded lock-free multi-producer multi-consumer ring buffer (Vyukov
+// sequence cells). Batches claim a whole range of cells with a single CAS.
+// Popping never blocks; consumers that run out of items wait elsewhere,
+// as the combat stages of Game do on an AsyncEvent.
+template <typename T>
+class MpmcQueue {
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  std::size_t mask_;
+  alignas(64) std::atomic<std::size_t> enqueue_pos_;
+  alignas(64) std::atomic<std::size_t> dequeue_pos_;
+  alignas(64) std::atomic<std::uint64_t> enqueued_;
+  std::atomic<std::uint64_t> dequeued_;
+  std::atomic<std::uint64_t> dropped_;
+  std::atomic<std::uint64_t> high_water_;
+
+  void UpdateHighWater(std::size_t size);
+
+ public:
+  explicit MpmcQueue(std::size_t capacity);
+
+  MpmcQueue(const MpmcQueue&) = delete;
+  MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+  std::size_t GetCapacity() const;
+  std::size_t SizeApprox() const;
+
+  bool TryPush(const T& value);
+  // Pushes as many items as fit and returns their count.
+  std::size_t TryPushBatch(std::span<const T> values);
+  // Same, but the items that did not fit are counted as dropped.
+  std::size_t PushBatch(std::span<const T> values);
+
+  bool TryPop(T& value);
+  std::size_t PopBatch(std::span<T> out);
+
+  QueueStats GetStats() const;
+};
+
+template <typename T>
+MpmcQueue<T>::MpmcQueue(std::size_t capacity)
+    : mask_(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+      enqueue_pos_(0),
+      dequeue_pos_(0),
+      enqueued_(0),
+      dequeued_(0),
+      dropped_(0),
+      high_water_(0) {
+  cells_ = std::make_unique<Cell[]>(mask_ + 1);
+  for (std::size_t i = 0; i <= mask_; ++i) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template <typename T>
+std::size_t MpmcQueue<T>::GetCapacity() const {
+  return mask_ + 1;
+}
+
+template <typename T>
+std::size_t MpmcQueue<T>::SizeApprox() const {
+  const std::size_t tail = dequeue_pos_.load(std::memory_order_relaxed);
+  const std::size_t head = enqueue_pos_.load(std::memory_order_relaxed);
+  return head > tail ? head - tail : 0;
+}
+
+template <typename T>
+bool MpmcQueue<T>::TryPush(const T& value) {
+  return PushBatch(std::span<const T>(&value, 1)) == 1;
+}
+
+template <typename T>
+std::size_t MpmcQueue<T>::TryPushBatch(std::span<const T> values) {
+  if (values.empty()) return 0;
+
+  std::size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  std::size_t count = 0;
+  while (true) {
+    const std::size_t tail = dequeue_pos_.load(std::memory_order_acquire);
+    const std::size_t used = pos - std::min(pos, tail);
+    count = std::min(values.size(), GetCapacity() - std::min(used, GetCapacity()));
+    if (count == 0) break;
+    if (enqueue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    Cell& cell = cells_[(pos + i) & mask_];
+    // The cell may still be drained by a consumer that claimed it a lap ago.
+    while (cell.sequence.load(std::memory_order_acquire) != pos + i) {
+      std::this_thread::yield();
+    }
+    cell.value = values[i];
+    cell.sequence.store(pos + i + 1, std::memory_order_release);
+  }
+
+  if (count > 0) {
+    enqueued_.fetch_add(count, std::memory_order_relaxed);
+    UpdateHighWater(SizeApprox());
+  }
+  return count;
+}
+
+template <typename T>
+std::size_t MpmcQueue<T>::PushBatch(std::span<const T> values) {
+  const std::size_t count = TryPushBatch(values);
+  if (count < values.size()) {
+    dropped_.fetch_add(values.size() - count, std::memory_order_relaxed);
+  }
+  return count;
+}
+
+template <typename T>
+bool MpmcQueue<T>::TryPop(T& value) {
+  return PopBatch(std::span<T>(&value, 1)) == 1;
+}
+
+template <typename T>
+std::size_t MpmcQueue<T>::PopBatch(std::span<T> out) {
+  if (out.empty()) return 0;
+
+  std::size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+  std::size_t count = 0;
+  while (true) {
+    // Only count cells whose producer has already published them.
+    count = 0;
+    while (count < out.size() &&
+           cells_[(pos + count) & mask_].sequence.load(std::memory_order_acquire) ==
+               pos + count + 1) {
+      ++count;
+    }
+    if (count == 0) {
+      const std::size_t current = dequeue_pos_.load(std::memory_order_relaxed);
+      if (current == pos) return 0;
+      pos = current;
+      continue;
+    }
+    if (dequeue_pos_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) break;
+  }
+
+  for (std::size_t i = 0; i < count; ++i) {
+    Cell& cell = cells_[(pos + i) & mask_];
+    out[i] = cell.value;
+    cell.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+  }
+  dequeued_.fetch_add(count, std::memory_order_relaxed);
+  return count;
+}
+
+template <typename T>
+void MpmcQueue<T>::UpdateHighWater(std::size_t size) {
+  std::uint64_t current = high_water_.load(std::memory_order_relaxed);
+  while (size > current &&
+         !high_water_.compare_exchange_weak(current, size, std::memory_order_relaxed)) {
+  }
+}
+
+template <typename T>
+QueueStats MpmcQueue<T>::GetStats() const {
+  QueueStats stats;
+  stats.enqueued = enqueued_.load(std::memory_order_relaxed);
+  stats.dequeued = dequeued_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.high_water = high_water_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace lab7
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <ostream>
 #include <shared_mutex>
 #include <string>
-#include <vector>
+
+#include "entity.hpp"
+#include "map_bounds.hpp"
 
 namespace lab7 {
 
@@ -12,33 +16,37 @@ class Bear;
 class Elf;
 class Robber;
 class FightVisitor;
-class IFightObserver;
-
-enum class NpcType {
-  Unknown = 0,
-  Bear = 1,
-  Elf = 2,
-  Robber = 3
-};
+class World;
 
 class NPC : public std::enable_shared_from_this<NPC> {
  protected:
   std::string name_;
   int x_;
   int y_;
+  // Bounds of a standalone NPC; bound ones use the world's.
+  MapBounds bounds_;
   NpcType type_;
   bool alive_;
   mutable std::shared_mutex mutex_;
-  std::vector<std::shared_ptr<IFightObserver>> observers_;
+  World* world_;
+  EntityId id_;
+  std::uint32_t generation_;
+  std::uint32_t serial_;
+  mutable std::atomic<std::uint32_t> roll_count_;
+
+  // Bound to a world entity that has not been compacted away yet.
+  bool IsCurrent() const;
 
  public:
-  NPC(NpcType type, const std::string& name, int x, int y);
+  // Coordinates outside the bounds are clamped to them.
+  NPC(NpcType type, const std::string& name, int x, int y, MapBounds bounds = {});
   virtual ~NPC() = default;
 
-  void Subscribe(std::shared_ptr<IFightObserver> observer);
-  void FightNotify(const std::shared_ptr<NPC>& attacker, 
-                   const std::shared_ptr<NPC>& defender, 
-                   bool win);
+  // Turns the NPC into a view of an entity stored in the world. Once the
+  // entity is compacted away the view is stale: it reports itself dead,
+  // ignores moves and kills, and keeps the name it was created with.
+  void Bind(World& world, EntityId id);
+  EntityId GetId() const;
 
   bool IsClose(const std::shared_ptr<NPC>& other, size_t distance) const;
   bool IsAlive() const;
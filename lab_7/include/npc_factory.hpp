@@ -5,23 +5,53 @@
 #include <string>
 #include <vector>
 
+#include "map_bounds.hpp"
 #include "npc.hpp"
+#include "npc_pool.hpp"
 
 namespace lab7 {
 
+// Coordinates must lie within the given bounds, which default to the
+// default map; loaders throw std::invalid_argument for any that do not.
 class NpcFactory {
  public:
   static std::shared_ptr<NPC> CreateNPC(NpcType type, 
                                         const std::string& name, 
                                         int x, 
-                                        int y);
+                                        int y,
+                                        const MapBounds& bounds = {});
 
-  static std::shared_ptr<NPC> CreateNPC(std::istream& is);
+  // Same, but the NPC and its control block come from the pool's arena.
+  static std::shared_ptr<NPC> CreateNPC(NpcType type,
+                                        const std::string& name,
+                                        int x,
+                                        int y,
+                                        NpcPool& pool,
+                                        const MapBounds& bounds = {});
+
+  static std::shared_ptr<NPC> CreateNPC(std::istream& is, const MapBounds& bounds = {});
+  static std::shared_ptr<NPC> CreateNPC(std::istream& is, NpcPool& pool,
+                                        const MapBounds& bounds = {});
 
   static void SaveToFile(const std::vector<std::shared_ptr<NPC>>& npcs,
                          const std::string& filename);
 
-  static std::vector<std::shared_ptr<NPC>> LoadFromFile(const std::string& filename);
+  static std::vector<std::shared_ptr<NPC>> LoadFromFile(const std::string& filename,
+                                                         const MapBounds& bounds = {});
+  static std::vector<std::shared_ptr<NPC>> LoadFromStream(std::istream& is,
+                                                           const MapBounds& bounds = {});
+  static std::vector<std::shared_ptr<NPC>> LoadFromStream(std::istream& is, NpcPool& pool,
+                                                           const MapBounds& bounds = {});
+
+  // Binary snapshot format (see world_snapshot.hpp); keeps names with
+  // spaces and the alive flag.
+  static void SaveToBinaryFile(const std::vector<std::shared_ptr<NPC>>& npcs,
+                               const std::string& filename);
+  static std::vector<std::shared_ptr<NPC>> LoadFromBinaryFile(const std::string& filename,
+                                                              const MapBounds& bounds = {});
+  static std::vector<std::shared_ptr<NPC>> LoadFromBinaryFile(const std::string& filename,
+                                                              NpcPool& pool,
+                                                              const MapBounds& bounds = {});
 };
 
 }  // namespace lab7
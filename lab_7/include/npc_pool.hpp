@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "npc.hpp"
+#include "npc_types.hpp"
+
+namespace lab7 {
+
+struct PoolStats {
+  std::uint64_t allocations = 0;
+  std::uint64_t deallocations = 0;
+  std::uint64_t slabs = 0;
+  std::uint64_t bytes_reserved = 0;
+};
+
+// Slab allocator for blocks of one size. Blocks are carved from large slabs
+// in order, freed blocks are reused LIFO, and all slabs are released at
+// once when the arena is destroyed.
+class NpcArena {
+ private:
+  mutable std::mutex mutex_;
+  std::size_t blocks_per_slab_;
+  std::size_t block_size_;
+  std::vector<std::unique_ptr<std::byte[]>> slabs_;
+  std::byte* bump_;
+  std::byte* bump_end_;
+  void* free_list_;
+  PoolStats stats_;
+
+ public:
+  explicit NpcArena(std::size_t blocks_per_slab);
+
+  NpcArena(const NpcArena&) = delete;
+  NpcArena& operator=(const NpcArena&) = delete;
+
+  // The first allocation fixes the block size of the arena.
+  void* Allocate(std::size_t bytes, std::size_t alignment);
+  void Deallocate(void* block);
+  PoolStats GetStats() const;
+};
+
+// Allocator for std::allocate_shared. Every control block keeps its arena
+// alive, so NPCs may outlive the pool that created them.
+template <typename T>
+class PoolAllocator {
+ private:
+  template <typename U>
+  friend class PoolAllocator;
+
+  std::shared_ptr<NpcArena> arena_;
+
+ public:
+  using value_type = T;
+
+  explicit PoolAllocator(std::shared_ptr<NpcArena> arena) noexcept : arena_(std::move(arena)) {}
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>& other) noexcept : arena_(other.arena_) {}
+
+  T* allocate(std::size_t n) {
+    if (n != 1) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T*>(arena_->Allocate(sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T* block, std::size_t /*n*/) noexcept {
+    arena_->Deallocate(block);
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>& other) const noexcept {
+    return arena_ == other.arena_;
+  }
+};
+
+// One arena per NPC type, for NpcFactory::CreateNPC.
+class NpcPool {
+ private:
+  std::array<std::shared_ptr<NpcArena>, NpcStats::kTypeCount> arenas_;
+
+ public:
+  explicit NpcPool(std::size_t blocks_per_slab = 1024);
+
+  template <typename T>
+  PoolAllocator<T> GetAllocator(NpcType type) const {
+    return PoolAllocator<T>(arenas_[static_cast<std::size_t>(type)]);
+  }
+
+  PoolStats GetStats() const;
+};
+
+}  // namespace lab7
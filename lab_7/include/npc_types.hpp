@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+
 #include "npc.hpp"
 
 namespace lab7::NpcStats {
@@ -46,4 +49,27 @@ constexpr const char* GetTypeName(NpcType type) {
   return "Unknown";
 }
 
+constexpr std::size_t kTypeCount = 4;
+
+// kKillMatrix[attacker][defender]: whether the attacker may try to kill the
+// defender. Rows and columns follow NpcType values.
+// clang-format off
+constexpr std::array<std::array<bool, kTypeCount>, kTypeCount> kKillMatrix = {{
+    // Unknown  Bear   Elf    Robber     attacker
+    {false,     false, false, false},  // Unknown
+    {false,     false, true,  false},  // Bear
+    {false,     false, false, true},   // Elf
+    {false,     false, false, true},   // Robber
+}};
+// clang-format on
+
+constexpr bool CanKill(NpcType attacker, NpcType defender) {
+  return kKillMatrix[static_cast<std::size_t>(attacker)][static_cast<std::size_t>(defender)];
+}
+
+static_assert(CanKill(NpcType::Bear, NpcType::Elf));
+static_assert(CanKill(NpcType::Elf, NpcType::Robber));
+static_assert(CanKill(NpcType::Robber, NpcType::Robber));
+static_assert(!CanKill(NpcType::Elf, NpcType::Bear));
+
 }  // namespace lab7::NpcStats
@@ -1,44 +1,55 @@
 #pragma once
 
+#include <chrono>
 #include <fstream>
 #include <memory>
 #include <mutex>
+#include <span>
 #include <string>
 
-namespace lab7 {
+#include "fight_log.hpp"
 
-class NPC;
+namespace lab7 {
 
+// Subscriber of a FightEventBus.
 class IFightObserver {
  public:
   virtual ~IFightObserver() = default;
-  virtual void OnFight(const std::shared_ptr<NPC>& attacker,
-                       const std::shared_ptr<NPC>& defender,
-                       bool win) = 0;
+  virtual void OnFight(const FightRecord& record) = 0;
+  // Matching fights of one dispatched batch, in batch order.
+  virtual void OnFights(std::span<const FightRecord> records);
+  virtual void Flush() {}
 };
 
+constexpr std::chrono::milliseconds kDefaultFlushInterval{100};
+
 class ConsoleObserver : public IFightObserver {
  private:
   static std::mutex cout_mutex_;
+  AsyncFightLog log_;
 
  public:
-  void OnFight(const std::shared_ptr<NPC>& attacker,
-               const std::shared_ptr<NPC>& defender,
-               bool win) override;
+  explicit ConsoleObserver(NameLookup names = {},
+                           std::chrono::milliseconds flush_interval = kDefaultFlushInterval);
+
+  void OnFight(const FightRecord& record) override;
+  void OnFights(std::span<const FightRecord> records) override;
+  void Flush() override;
 };
 
 class FileObserver : public IFightObserver {
  private:
   std::ofstream log_file_;
+  AsyncFightLog log_;
 
  public:
-  explicit FileObserver(const std::string& filename);
+  explicit FileObserver(const std::string& filename, NameLookup names = {},
+                        std::chrono::milliseconds flush_interval = kDefaultFlushInterval);
   ~FileObserver();
 
-  void OnFight(const std::shared_ptr<NPC>& attacker,
-               const std::shared_ptr<NPC>& defender,
-               bool win) override;
+  void OnFight(const FightRecord& record) override;
+  void OnFights(std::span<const FightRecord> records) override;
+  void Flush() override;
 };
 
 }  // namespace lab7
-
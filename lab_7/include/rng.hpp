@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "simd.hpp"
+
+namespace lab7 {
+
+enum class RngStream : std::uint32_t {
+  Spawn = 1,
+  Movement = 2,
+  Dice = 3
+};
+
+using RandomBlock = std::array<std::uint32_t, 4>;
+
+// Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2,
+// 3"): ten rounds of a keyed bijection on a 128-bit counter.
+constexpr RandomBlock Philox4x32(RandomBlock counter, std::uint64_t key) {
+  auto key_lo = static_cast<std::uint32_t>(key);
+  auto key_hi = static_cast<std::uint32_t>(key >> 32);
+  for (int round = 0; round < 10; ++round) {
+    const std::uint64_t product0 = 0xD2511F53ULL * counter[0];
+    const std::uint64_t product1 = 0xCD9E8D57ULL * counter[2];
+    counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key_lo,
+               static_cast<std::uint32_t>(product1),
+               static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key_hi,
+               static_cast<std::uint32_t>(product0)};
+    key_lo += 0x9E3779B9U;
+    key_hi += 0xBB67AE85U;
+  }
+  return counter;
+}
+
+// Counter of block `index` of a stream: {index, entity, tick low bits,
+// stream and tick high bits}. Ticks are unique up to 2^56.
+constexpr RandomBlock MakeRngCounter(RngStream stream, std::uint32_t entity, std::uint64_t tick,
+                                     std::uint32_t index = 0) {
+  return {index, entity, static_cast<std::uint32_t>(tick),
+          (static_cast<std::uint32_t>(stream) << 24) ^ static_cast<std::uint32_t>(tick >> 32)};
+}
+
+// Stateless counter-based generator: the n-th value of a stream depends only
+// on (seed, stream, entity, tick, n), so results do not depend on which
+// thread draws them or in which order streams are consumed. Draws are taken
+// from Philox blocks, four 32-bit words at a time.
+class CounterRng {
+ private:
+  std::uint64_t key_;
+  RandomBlock counter_;
+  RandomBlock block_{};
+  std::uint32_t used_ = 4;
+
+ public:
+  constexpr CounterRng(std::uint64_t seed, RngStream stream, std::uint32_t entity,
+                       std::uint64_t tick)
+      : key_(seed), counter_(MakeRngCounter(stream, entity, tick)) {}
+
+  constexpr std::uint32_t NextWord() {
+    if (used_ == 4) {
+      block_ = Philox4x32(counter_, key_);
+      ++counter_[0];
+      used_ = 0;
+    }
+    return block_[used_++];
+  }
+
+  constexpr std::uint64_t Next() {
+    const std::uint64_t high = NextWord();
+    return (high << 32) | NextWord();
+  }
+
+  // Uniform integer in [min, max]; takes one word.
+  constexpr int NextInt(int min, int max) {
+    return ToInt(NextWord(), min, max);
+  }
+
+  // Uniform real in [min, max); takes two words.
+  constexpr double NextReal(double min, double max) {
+    const std::uint32_t high = NextWord();
+    return ToReal(high, NextWord(), min, max);
+  }
+
+  // The conversions above, for words taken from FillRandomBlocks().
+  static constexpr int ToInt(std::uint32_t word, int min, int max) {
+    const auto range = static_cast<std::uint64_t>(max - min) + 1;
+    return min + static_cast<int>(word * range >> 32);
+  }
+
+  static constexpr double ToReal(std::uint32_t high, std::uint32_t low, double min, double max) {
+    const std::uint64_t bits = ((static_cast<std::uint64_t>(high) << 32) | low) >> 11;
+    return min + (max - min) * static_cast<double>(bits) * 0x1.0p-53;
+  }
+};
+
+// out[i] = first block of CounterRng(seed, stream, entities[i], tick), so
+// its words are that generator's first four draws. out has as many elements
+// as entities. The second overload uses a given supported level.
+void FillRandomBlocks(std::uint64_t seed, RngStream stream, std::span<const std::uint32_t> entities,
+                      std::uint64_t tick, std::span<RandomBlock> out);
+void FillRandomBlocks(SimdLevel level, std::uint64_t seed, RngStream stream,
+                      std::span<const std::uint32_t> entities, std::uint64_t tick,
+                      std::span<RandomBlock> out);
+
+}  // namespace lab7
@@ -7,7 +7,7 @@ namespace lab7 {
 
 class Robber : public NPC, public FightVisitor {
  public:
-  Robber(const std::string& name, int x, int y);
+  Robber(const std::string& name, int x, int y, MapBounds bounds = {});
 
   bool Accept(std::shared_ptr<FightVisitor> visitor) override;
 
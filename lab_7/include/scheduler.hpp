@@ -0,0 +1,238 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace lab7 {
+
+class Scheduler;
+class TaskGroup;
+
+// Fire-and-forget coroutine. It starts suspended and runs once spawned on a
+// Scheduler; its frame is freed when it returns.
+class Task {
+ public:
+  struct promise_type {
+    TaskGroup* group = nullptr;
+
+    Task get_return_object() {
+      return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept {
+      return {};
+    }
+    auto final_suspend() noexcept;
+    void return_void() {}
+    void unhandled_exception();
+  };
+
+ private:
+  std::coroutine_handle<promise_type> handle_;
+
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+  friend class Scheduler;
+
+ public:
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task& operator=(Task&&) = delete;
+  ~Task();
+};
+
+// Coroutines spawned together, such as the stages of one game.
+// Scheduler::RunUntilDone() returns once none of them is left.
+class TaskGroup {
+ private:
+  Scheduler* scheduler_ = nullptr;
+  // Guarded by the scheduler's mutex.
+  std::size_t active_ = 0;
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+  std::function<void()> on_error_;
+
+  friend class Scheduler;
+  friend struct Task::promise_type;
+
+  void Finish();
+  void Fail(std::exception_ptr error);
+
+ public:
+  // on_error runs on the first exception that escapes a coroutine of the
+  // group, typically to ask the others to stop.
+  explicit TaskGroup(std::function<void()> on_error = {});
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  // First exception thrown by a coroutine of the group, if any; clears it.
+  std::exception_ptr TakeError();
+};
+
+inline auto Task::promise_type::final_suspend() noexcept {
+  struct FinalAwaiter {
+    bool await_ready() noexcept {
+      return false;
+    }
+    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+      TaskGroup* group = handle.promise().group;
+      handle.destroy();
+      group->Finish();
+    }
+    void await_resume() noexcept {}
+  };
+  return FinalAwaiter{};
+}
+
+// Suspended coroutine waiting for an event, a deadline or both. Whichever
+// comes first claims the waiter and schedules the coroutine.
+struct EventWaiter {
+  using Clock = std::chrono::steady_clock;
+
+  std::coroutine_handle<> handle;
+  std::atomic<bool> claimed{false};
+  bool timed_out = false;
+  // Guarded by the scheduler's mutex.
+  bool in_timers = false;
+  std::multimap<Clock::time_point, EventWaiter*>::iterator timer;
+};
+
+// Runs coroutines on a fixed set of worker threads. Ready coroutines are
+// resumed in FIFO order; a coroutine suspended on a timer or an AsyncEvent
+// takes no thread. Callers of RunUntilDone() work as extra workers, so a
+// scheduler without workers runs everything on the thread that waits.
+class Scheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::coroutine_handle<>> ready_;
+  std::multimap<Clock::time_point, EventWaiter*> timers_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+
+  friend class AsyncEvent;
+  friend class TaskGroup;
+
+  void Schedule(std::coroutine_handle<> handle);
+  void AddTimer(EventWaiter& waiter, Clock::time_point deadline);
+  void RemoveTimer(EventWaiter& waiter);
+  // Resumes coroutines until done() holds; called and returns with the
+  // lock held.
+  template <typename Done>
+  void Drive(std::unique_lock<std::mutex>& lock, Done done);
+
+ public:
+  explicit Scheduler(std::size_t worker_count);
+  // Waits for the workers; every group must be done by then.
+  ~Scheduler();
+
+  Scheduler(const Scheduler&) = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  std::size_t GetWorkerCount() const;
+
+  void Spawn(Task task, TaskGroup& group);
+  // Helps running coroutines until every coroutine of the group returned.
+  void RunUntilDone(TaskGroup& group);
+
+  // co_await Yield() lets the coroutines that are already ready run first.
+  auto Yield() {
+    struct YieldAwaiter {
+      Scheduler& scheduler;
+
+      bool await_ready() noexcept {
+        return false;
+      }
+      void await_suspend(std::coroutine_handle<> handle) {
+        scheduler.Schedule(handle);
+      }
+      void await_resume() noexcept {}
+    };
+    return YieldAwaiter{*this};
+  }
+};
+
+// Manual-reset event for coroutines: Set() resumes every waiter and lets
+// later waits pass until Reset().
+class AsyncEvent {
+ public:
+  using Clock = Scheduler::Clock;
+
+ private:
+  Scheduler& scheduler_;
+  mutable std::mutex mutex_;
+  bool set_ = false;
+  std::vector<EventWaiter*> waiters_;
+
+  // Registers the waiter, and its deadline if any, unless the event is
+  // set; false means it is set.
+  bool Suspend(EventWaiter& waiter, const Clock::time_point* deadline);
+  // Unregisters a resumed waiter from whatever did not resume it.
+  void Remove(EventWaiter& waiter);
+
+ public:
+  explicit AsyncEvent(Scheduler& scheduler);
+
+  AsyncEvent(const AsyncEvent&) = delete;
+  AsyncEvent& operator=(const AsyncEvent&) = delete;
+
+  void Set();
+  void Reset();
+  bool IsSet() const;
+
+  // co_await Wait() suspends until the event is set.
+  auto Wait() {
+    struct Awaiter {
+      AsyncEvent& event;
+      EventWaiter waiter;
+
+      bool await_ready() noexcept {
+        return false;
+      }
+      bool await_suspend(std::coroutine_handle<> handle) {
+        waiter.handle = handle;
+        return event.Suspend(waiter, nullptr);
+      }
+      void await_resume() noexcept {}
+    };
+    return Awaiter{*this, {}};
+  }
+
+  // co_await WaitUntil(deadline) is true if the event was set before the
+  // deadline and false on timeout.
+  auto WaitUntil(Clock::time_point deadline) {
+    struct Awaiter {
+      AsyncEvent& event;
+      Clock::time_point deadline;
+      EventWaiter waiter;
+
+      bool await_ready() noexcept {
+        return false;
+      }
+      bool await_suspend(std::coroutine_handle<> handle) {
+        waiter.handle = handle;
+        return event.Suspend(waiter, &deadline);
+      }
+      bool await_resume() {
+        event.Remove(waiter);
+        return !waiter.timed_out;
+      }
+    };
+    return Awaiter{*this, deadline, {}};
+  }
+};
+
+}  // namespace lab7
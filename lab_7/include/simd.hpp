@@ -0,0 +1,19 @@
+#pragma once
+
+namespace lab7 {
+
+// Vector instruction sets the batched kernels are built for. Kernels are
+// compiled with target attributes and picked at run time, so one binary
+// runs everywhere; non-x86 builds only have the scalar versions.
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+// Best level supported by this CPU, detected once.
+SimdLevel GetSimdLevel();
+const char* GetSimdLevelName(SimdLevel level);
+bool IsSupported(SimdLevel level);
+
+}  // namespace lab7
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LAB7_X86_SIMD 1
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "spatial_grid.hpp"
+
+namespace lab7 {
+
+// Spatial hash for maps too large for SpatialGrid. Only populated cells are
+// stored: an open-addressing table maps cell coordinates to a cell number,
+// and entries are counting-sorted by that number, so memory grows with the
+// entries and populated cells instead of with the map area.
+//
+// Each lookup of a large table is a cache miss, so Build() widens the cells
+// beyond min_cell_size until they hold about one entry each on average;
+// a query then looks up one to four cells. If the populated cells end up
+// holding more than two entries on average, as with a crowd plus one far-off
+// straggler, it shrinks them again, down to min_cell_size at most.
+class SparseGrid {
+ private:
+  static constexpr std::uint64_t kEmptyKey = UINT64_MAX;
+  static constexpr std::uint32_t kNoCell = UINT32_MAX;
+
+  struct Slot {
+    std::uint64_t key;
+    std::uint32_t cell;
+  };
+
+  int min_cell_size_;
+  int cell_size_;
+  // Power-of-two table, at most half full.
+  std::vector<Slot> slots_;
+  int slot_shift_ = 64;
+  std::size_t cell_count_ = 0;
+  std::vector<std::uint32_t> cell_start_;
+  std::vector<std::uint32_t> entry_index_;
+  std::vector<int> entry_x_;
+  std::vector<int> entry_y_;
+  std::vector<std::uint32_t> entry_cell_;
+  std::vector<std::uint32_t> cursor_;
+
+  int CellCoord(int value) const;
+  static std::uint64_t GetKey(int cx, int cy);
+  std::size_t GetHome(std::uint64_t key) const;
+  void Resize(std::size_t capacity);
+  std::uint32_t Insert(std::uint64_t key);
+  // Fills the table with the cells of the current size and counts their
+  // entries into cell_start_.
+  void AssignCells(std::span<const int> xs, std::span<const int> ys);
+  // Cell number of a populated cell, kNoCell for an empty one.
+  std::uint32_t Find(std::uint64_t key) const;
+
+ public:
+  explicit SparseGrid(int min_cell_size);
+
+  void Build(std::span<const int> xs, std::span<const int> ys);
+
+  // Same contract as SpatialGrid::ForEachInRadius, in another order.
+  template <typename Fn>
+  void ForEachInRadius(int x, int y, int radius, Fn&& fn) const;
+
+  // Cell size of the last Build().
+  int GetCellSize() const;
+  std::size_t GetEntryCount() const;
+  std::size_t GetCellCount() const;
+  // Bytes held by the grid's arrays.
+  std::size_t GetMemoryUsage() const;
+};
+
+inline int SparseGrid::CellCoord(int value) const {
+  return std::max(value, 0) / cell_size_;
+}
+
+inline std::uint64_t SparseGrid::GetKey(int cx, int cy) {
+  return static_cast<std::uint64_t>(static_cast<std::uint32_t>(cy)) << 32 |
+         static_cast<std::uint32_t>(cx);
+}
+
+inline std::size_t SparseGrid::GetHome(std::uint64_t key) const {
+  return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> slot_shift_);
+}
+
+inline std::uint32_t SparseGrid::Find(std::uint64_t key) const {
+  const std::size_t mask = slots_.size() - 1;
+  for (std::size_t slot = GetHome(key);; slot = (slot + 1) & mask) {
+    if (slots_[slot].key == key) return slots_[slot].cell;
+    if (slots_[slot].key == kEmptyKey) return kNoCell;
+  }
+}
+
+template <typename Fn>
+void SparseGrid::ForEachInRadius(int x, int y, int radius, Fn&& fn) const {
+  const int min_cx = CellCoord(x - radius);
+  const int max_cx = CellCoord(x + radius);
+  const int min_cy = CellCoord(y - radius);
+  const int max_cy = CellCoord(y + radius);
+
+  for (int cy = min_cy; cy <= max_cy; ++cy) {
+    for (int cx = min_cx; cx <= max_cx; ++cx) {
+      const std::uint32_t cell = Find(GetKey(cx, cy));
+      if (cell == kNoCell) continue;
+      ForEachInRun(entry_index_, entry_x_, entry_y_, cell_start_[cell], cell_start_[cell + 1], x,
+                   y, radius, fn);
+    }
+  }
+}
+
+}  // namespace lab7
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "distance_kernel.hpp"
+
+namespace lab7 {
+
+// Shorter runs are tested inline; the kernel call costs more. At the
+// default density a 50-unit kill distance spans rows of about 5 entries,
+// so the longer ones take the kernel (see BM_ForEachInRun).
+inline constexpr std::uint32_t kMinKernelRun = 8;
+
+// Calls fn(index[e]) for every entry e in [begin, end) of a grid's SoA
+// arrays that lies within radius of (x, y). Shared by SpatialGrid and
+// SparseGrid; runs of at least min_kernel_run entries use WithinRadius.
+template <typename Fn>
+void ForEachInRun(std::span<const std::uint32_t> index, std::span<const int> xs,
+                  std::span<const int> ys, std::uint32_t begin, std::uint32_t end, int x, int y,
+                  int radius, Fn& fn, std::uint32_t min_kernel_run = kMinKernelRun) {
+  if (end - begin < min_kernel_run) {
+    const std::int64_t radius_sq = static_cast<std::int64_t>(radius) * radius;
+    for (std::uint32_t e = begin; e < end; ++e) {
+      const std::int64_t dx = static_cast<std::int64_t>(xs[e]) - x;
+      const std::int64_t dy = static_cast<std::int64_t>(ys[e]) - y;
+      if (dx * dx + dy * dy <= radius_sq) {
+        fn(static_cast<std::size_t>(index[e]));
+      }
+    }
+    return;
+  }
+
+  for (std::uint32_t block = begin; block < end; block += kDistanceBlock) {
+    const std::size_t count = std::min<std::size_t>(kDistanceBlock, end - block);
+    std::uint64_t hits =
+        WithinRadius(xs.subspan(block, count), ys.subspan(block, count), x, y, radius);
+    for (; hits != 0; hits &= hits - 1) {
+      fn(static_cast<std::size_t>(index[block + std::countr_zero(hits)]));
+    }
+  }
+}
+
+// Uniform grid over a square map. Rebuilt from scratch each tick with a
+// counting sort, so entries of one cell are contiguous in memory.
+class SpatialGrid {
+ private:
+  int map_size_;
+  int cell_size_;
+  int cells_per_side_;
+  std::vector<std::uint32_t> cell_start_;
+  std::vector<std::uint32_t> entry_index_;
+  std::vector<int> entry_x_;
+  std::vector<int> entry_y_;
+  std::vector<std::uint32_t> entry_cell_;
+  std::vector<std::uint32_t> cursor_;
+
+  int CellCoord(int value) const;
+
+ public:
+  SpatialGrid(int map_size, int cell_size);
+
+  void Build(std::span<const int> xs, std::span<const int> ys);
+
+  // Calls fn(index) for every built entry within radius of (x, y),
+  // where index is the position of the entry in the arrays given to Build.
+  template <typename Fn>
+  void ForEachInRadius(int x, int y, int radius, Fn&& fn) const;
+
+  int GetCellSize() const;
+  std::size_t GetEntryCount() const;
+  // Bytes held by the grid's arrays.
+  std::size_t GetMemoryUsage() const;
+};
+
+template <typename Fn>
+void SpatialGrid::ForEachInRadius(int x, int y, int radius, Fn&& fn) const {
+  const int min_cx = CellCoord(x - radius);
+  const int max_cx = CellCoord(x + radius);
+  const int min_cy = CellCoord(y - radius);
+  const int max_cy = CellCoord(y + radius);
+
+  for (int cy = min_cy; cy <= max_cy; ++cy) {
+    const std::size_t row = static_cast<std::size_t>(cy) * cells_per_side_;
+    ForEachInRun(entry_index_, entry_x_, entry_y_, cell_start_[row + min_cx],
+                 cell_start_[row + max_cx + 1], x, y, radius, fn);
+  }
+}
+
+}  // namespace lab7
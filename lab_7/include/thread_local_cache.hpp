@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace lab7 {
+
+inline constexpr std::size_t kThreadLocalCacheLimit = 16;
+
+// Returns the calling thread's T registered for `owner`, creating it with
+// `make` (which must return a T& that outlives the owner) on first use.
+// Owners must carry process-unique ids so entries of destroyed owners are
+// never matched. The per-thread cache keeps the kThreadLocalCacheLimit most
+// recently used owners: entries of destroyed owners age out, while owners
+// still in use keep their T.
+template <typename T, typename Make>
+T& ThreadLocalFor(std::uint64_t owner, Make&& make) {
+  // Most recently used last.
+  thread_local std::vector<std::pair<std::uint64_t, T*>> cache;
+  for (auto it = cache.rbegin(); it != cache.rend(); ++it) {
+    if (it->first != owner) continue;
+    T& value = *it->second;
+    std::rotate(std::prev(it.base()), it.base(), cache.end());
+    return value;
+  }
+  if (cache.size() >= kThreadLocalCacheLimit) {
+    cache.erase(cache.begin());
+  }
+
+  T& value = std::forward<Make>(make)();
+  cache.emplace_back(owner, &value);
+  return value;
+}
+
+}  // namespace lab7
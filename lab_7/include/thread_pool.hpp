@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lab7 {
+
+// Work-stealing pool. Each worker owns a deque: it pops its own tasks from
+// the back and steals from the front of the others. The thread calling
+// ParallelFor takes part in the work, so a pool of N threads starts N - 1
+// workers and a pool of one thread runs everything inline.
+class ThreadPool {
+ private:
+  struct Worker {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  std::atomic<std::size_t> queued_;
+  std::atomic<std::size_t> next_worker_;
+  bool stop_;
+
+  void WorkerLoop(std::size_t self);
+  bool TryRunOne(std::size_t self);
+  void Push(std::function<void()> task);
+
+ public:
+  explicit ThreadPool(std::size_t thread_count = std::thread::hardware_concurrency());
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t GetThreadCount() const;
+
+  // Splits [0, count) into chunks and calls fn(chunk, begin, end) for each,
+  // blocking until all chunks are done. Chunk numbers are dense and ordered.
+  // If fn throws, the remaining chunks still run and the first exception is
+  // rethrown once they are done.
+  void ParallelFor(std::size_t count, std::size_t min_chunk,
+                   const std::function<void(std::size_t, std::size_t, std::size_t)>& fn);
+  std::size_t GetChunkCount(std::size_t count, std::size_t min_chunk) const;
+};
+
+}  // namespace lab7
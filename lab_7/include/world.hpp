@@ -0,0 +1,143 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "map_bounds.hpp"
+#include "npc.hpp"
+
+namespace lab7 {
+
+// Id of an entity together with the generation of its slot. Slots of
+// removed entities are reused, so a handle kept past removal is detectably
+// stale rather than pointing at whoever took the slot.
+struct EntityHandle {
+  EntityId id;
+  std::uint32_t generation;
+};
+
+// Everything a slot holds, as checkpoints store it. The name is empty when
+// it is generated from the id.
+struct EntityState {
+  int x;
+  int y;
+  NpcType type;
+  bool alive;
+  std::uint32_t roll_count;
+  std::uint32_t generation;
+  std::string_view name;
+};
+
+// Packed structure-of-arrays storage for all entities of a game, indexed by
+// EntityId. Positions and liveness may be read and written concurrently;
+// adding entities or clearing the world requires exclusive access.
+//
+// Entities are never moved. Live ids are kept in a separate list that
+// Compact() rebuilds without the dead, so per-tick loops cost O(live); the
+// slots of compacted entities go to a free list for later Add() calls.
+//
+// Slots whose position, liveness or dice count change, and slots that are
+// added or freed, are marked in a bitmap so that incremental checkpoints
+// visit only what changed; changes to the live or free lists are flagged as
+// a whole.
+class World {
+ private:
+  std::vector<int> x_;
+  std::vector<int> y_;
+  std::vector<NpcType> type_;
+  std::vector<std::uint8_t> alive_;
+  std::vector<std::uint32_t> name_id_;
+  std::vector<std::string> names_;
+  std::vector<std::uint32_t> roll_count_;
+  std::vector<std::uint8_t> claimed_;
+  std::vector<std::uint32_t> generation_;
+  std::vector<EntityId> live_;
+  std::vector<EntityId> free_;
+  std::vector<std::uint64_t> changed_;
+  bool layout_changed_ = true;
+  std::atomic<std::uint32_t> pending_dead_{0};
+  std::uint64_t seed_ = 0;
+  MapBounds bounds_;
+
+  void MarkChanged(EntityId id);
+  void Resize(std::size_t count);
+
+ public:
+  static constexpr std::uint32_t kGeneratedName = UINT32_MAX;
+
+  World() = default;
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
+  EntityId Add(NpcType type, int x, int y, std::string_view name = {});
+  void Reserve(std::size_t count);
+  void Clear();
+  // Number of slots, including dead and free ones.
+  std::size_t Size() const;
+
+  // Ids of entities that were alive at the last compaction, ascending
+  // unless freed slots have been reused.
+  std::span<const EntityId> LiveIds() const;
+  // Entities killed since the last compaction.
+  std::size_t GetPendingDeadCount() const;
+  bool ShouldCompact() const;
+  // Drops dead entities from the live list and frees their slots. Must not
+  // run concurrently with readers of LiveIds() or with Add().
+  std::size_t Compact();
+
+  EntityHandle GetHandle(EntityId id) const;
+  // False once the entity has been compacted away.
+  bool IsCurrent(EntityHandle handle) const;
+
+  void SetSeed(std::uint64_t seed);
+  std::uint64_t GetSeed() const;
+  // Bounds NPC views clamp their moves to; systems get theirs from the
+  // game configuration.
+  void SetBounds(MapBounds bounds);
+  const MapBounds& GetBounds() const;
+
+  int GetX(EntityId id) const;
+  int GetY(EntityId id) const;
+  void SetPosition(EntityId id, int x, int y);
+  NpcType GetType(EntityId id) const;
+  std::string GetName(EntityId id) const;
+  // Empty when the name is generated from the id.
+  std::string_view GetStoredName(EntityId id) const;
+
+  bool IsAlive(EntityId id) const;
+  // Returns true only for the call that actually killed the entity.
+  bool Kill(EntityId id);
+
+  // Exclusive claim on an entity for one fight. Combat workers claim both
+  // sides before resolving, so nobody else can kill either of them midway.
+  bool TryClaim(EntityId id);
+  void Release(EntityId id);
+
+  // D6 roll from the entity's own dice stream.
+  int RollDice(EntityId id);
+
+  // Checkpoint support. GetChangedIds() appends the ids marked since the
+  // last ClearChanges() in ascending order. SetState() overwrites a slot,
+  // growing the world if needed, and SetLayout() replaces the live and free
+  // lists; the setters mark nothing and need exclusive access.
+  EntityState GetState(EntityId id) const;
+  void SetState(EntityId id, const EntityState& state);
+  std::span<const EntityId> FreeIds() const;
+  void SetLayout(std::span<const EntityId> live, std::span<const EntityId> free);
+  void SetPendingDeadCount(std::size_t count);
+  void GetChangedIds(std::vector<EntityId>& ids) const;
+  bool IsLayoutChanged() const;
+  void ClearChanges();
+
+  // Raw column views for the thread that owns position updates.
+  std::span<const int> Xs() const;
+  std::span<const int> Ys() const;
+  std::span<const NpcType> Types() const;
+};
+
+}  // namespace lab7
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "npc.hpp"
+
+namespace lab7 {
+
+class World;
+
+struct FrameEntry {
+  EntityId id;
+  NpcType type;
+  int x;
+  int y;
+};
+
+// Immutable picture of the live entities at the end of a tick. Names are
+// not copied: they are read from the world, which never changes them while
+// frames of it are alive.
+class WorldFrame {
+ private:
+  std::uint64_t tick_ = 0;
+  std::vector<FrameEntry> entries_;
+  const World* world_ = nullptr;
+
+  friend class FrameBuffer;
+
+ public:
+  std::uint64_t GetTick() const;
+  std::span<const FrameEntry> Entries() const;
+  std::size_t Size() const;
+  std::string GetName(EntityId id) const;
+};
+
+class FrameBuffer;
+
+// Keeps a published frame from being overwritten until released.
+class FrameView {
+ private:
+  const FrameBuffer* buffer_ = nullptr;
+  std::size_t slot_ = 0;
+
+  friend class FrameBuffer;
+  FrameView(const FrameBuffer* buffer, std::size_t slot);
+
+ public:
+  FrameView() = default;
+  ~FrameView();
+
+  FrameView(FrameView&& other) noexcept;
+  FrameView& operator=(FrameView&& other) noexcept;
+
+  const WorldFrame& operator*() const;
+  const WorldFrame* operator->() const;
+};
+
+// Triple-buffered frames with one writer and any number of readers. Readers
+// pin the published slot with a counter, without locks or per-entity
+// reference counts. The writer fills a slot nobody pins and publishes it
+// with a single store; if every spare slot is still pinned, that tick is
+// skipped rather than waiting for readers.
+class FrameBuffer {
+ private:
+  static constexpr std::size_t kSlotCount = 3;
+
+  struct Slot {
+    WorldFrame frame;
+    alignas(64) mutable std::atomic<std::uint32_t> readers{0};
+  };
+
+  std::array<Slot, kSlotCount> slots_;
+  alignas(64) std::atomic<std::size_t> published_{0};
+
+  friend class FrameView;
+  void Release(std::size_t slot) const;
+
+ public:
+  FrameView Acquire() const;
+
+  // Writer side. Returns false if the frame was skipped.
+  bool Publish(const World& world, std::uint64_t tick);
+  // Publishes an empty frame and waits until no reader pins an old one.
+  void Clear();
+};
+
+}  // namespace lab7
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "npc.hpp"
+
+namespace lab7 {
+
+class MappedFile;
+class World;
+
+// Binary snapshot layout (little-endian, native alignment):
+//   SnapshotHeader
+//   SnapshotRecord[record_count]
+//   string table: names without separators, addressed by offset and length
+// The checksum covers everything after the header.
+struct SnapshotHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t record_size;
+  std::uint64_t record_count;
+  std::uint64_t string_table_size;
+  std::uint64_t checksum;
+};
+
+struct SnapshotRecord {
+  std::int32_t x;
+  std::int32_t y;
+  // kGeneratedName when the entity has no stored name.
+  std::uint32_t name_offset;
+  std::uint32_t name_length;
+  NpcType type;
+  std::uint8_t alive;
+  std::uint8_t reserved[2];
+};
+
+static_assert(sizeof(SnapshotHeader) == 40);
+static_assert(sizeof(SnapshotRecord) == 20);
+
+// Read-only view of a snapshot file mapped into memory (see MappedFile). Records and names
+// are served straight from the mapping; the file is validated (magic,
+// version, sizes, checksum) once in the constructor.
+class WorldSnapshot {
+ private:
+  std::unique_ptr<MappedFile> file_;
+  const SnapshotHeader* header_;
+  std::span<const SnapshotRecord> records_;
+  std::string_view strings_;
+
+ public:
+  static constexpr char kMagic[8] = {'L', 'A', 'B', '7', 'S', 'N', 'A', 'P'};
+  static constexpr std::uint32_t kVersion = 1;
+  static constexpr std::uint32_t kGeneratedName = UINT32_MAX;
+
+  explicit WorldSnapshot(const std::string& filename);
+  ~WorldSnapshot();
+
+  WorldSnapshot(const WorldSnapshot&) = delete;
+  WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+  static void Save(const World& world, const std::string& filename);
+  static void Save(const std::vector<std::shared_ptr<NPC>>& npcs, const std::string& filename);
+
+  std::size_t Size() const;
+  std::span<const SnapshotRecord> Records() const;
+  std::string_view GetName(const SnapshotRecord& record) const;
+
+  // Appends all entities to the world, keeping dead ones dead.
+  void LoadInto(World& world) const;
+};
+
+}  // namespace lab7
@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "batch_runner.hpp"
+
+namespace {
+
+constexpr std::uint64_t kDefaultTickBudget = 1000;
+
+int Usage() {
+  std::cerr << "Usage:\n"
+            << "  lab7_batch <worlds> [options]\n"
+            << "Runs independent worlds with seeds seed, seed + 1, ... (default seed 1)\n"
+            << "on --threads workers. Each world stops after --ticks (default "
+            << kDefaultTickBudget << ";\n"
+            << "unlimited: until no kill is possible). Options:\n"
+            << lab7::GameConfig::GetHelp() << std::flush;
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    return Usage();
+  }
+
+  lab7::GameConfig config;
+  config.tick_budget = kDefaultTickBudget;
+  std::size_t world_count = 0;
+  try {
+    world_count = std::stoull(argv[1]);
+    config.ParseArgs(argc, argv, 2);
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return Usage();
+  }
+
+  try {
+    lab7::BatchRunner runner(config, world_count);
+    const std::size_t report_every = std::max<std::size_t>(world_count / 10, 1);
+    const auto report = runner.Run([&](const lab7::WorldResult&, const lab7::BatchStats& stats) {
+      if (stats.GetWorldCount() % report_every == 0) {
+        std::cerr << "\r" << stats.GetWorldCount() << "/" << world_count << " worlds"
+                  << std::flush;
+      }
+    });
+    std::cerr << std::endl;
+
+    std::cout << "NPCs " << config.npc_count << ", map " << config.map_size << ", threads "
+              << config.thread_count << "\n";
+    report.stats.Print(std::cout);
+    std::cout << "Throughput: " << report.GetWorldsPerSecond() << " worlds/s over "
+              << report.elapsed.count() << " s" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
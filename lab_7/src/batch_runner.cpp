@@ -0,0 +1,231 @@
+#include "batch_runner.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+
+#include "game.hpp"
+#include "observer.hpp"
+
+namespace lab7 {
+namespace {
+
+constexpr std::array<NpcType, 3> kTypes = {NpcType::Bear, NpcType::Elf, NpcType::Robber};
+
+std::size_t Index(NpcType type) {
+  return static_cast<std::size_t>(type);
+}
+
+class KillCounter : public IFightObserver {
+ private:
+  KillMatrix kills_{};
+
+ public:
+  const KillMatrix& GetKills() const {
+    return kills_;
+  }
+
+  void OnFight(const FightRecord& record) override {
+    if (record.outcome == CombatOutcome::DefenderWon) {
+      ++kills_[Index(record.defender_type)][Index(record.attacker_type)];
+    } else {
+      ++kills_[Index(record.attacker_type)][Index(record.defender_type)];
+    }
+  }
+};
+
+TypeCounts CountAlive(const Game& game) {
+  TypeCounts counts{};
+  const FrameView frame = game.GetSnapshot();
+  for (const FrameEntry& entry : frame->Entries()) {
+    ++counts[Index(entry.type)];
+  }
+  return counts;
+}
+
+bool CanStillKill(const TypeCounts& alive) {
+  for (const NpcType attacker : kTypes) {
+    for (const NpcType defender : kTypes) {
+      const std::uint64_t needed = attacker == defender ? 2 : 1;
+      if (NpcStats::CanKill(attacker, defender) && alive[Index(attacker)] > 0 &&
+          alive[Index(defender)] >= needed) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+GameConfig MakeWorldConfig(const GameConfig& config) {
+  GameConfig world = config;
+  world.headless = true;
+  world.thread_count = 1;
+  // Worlds only Step(), so their schedulers never run a stage.
+  world.worker_threads = 0;
+  world.metrics_file.clear();
+  world.journal_file.clear();
+  return world;
+}
+
+WorldResult Simulate(Game& game, const GameConfig& config, std::uint64_t seed) {
+  WorldResult result;
+  result.seed = seed;
+  game.Initialize(config.npc_count, seed);
+  const auto kills = std::make_shared<KillCounter>();
+  game.Subscribe(kills);
+  result.initial = result.survivors = CountAlive(game);
+
+  while (CanStillKill(result.survivors) &&
+         (config.tick_budget == 0 || result.ticks < config.tick_budget)) {
+    game.Step();
+    ++result.ticks;
+    result.survivors = CountAlive(game);
+  }
+  result.kills = kills->GetKills();
+  return result;
+}
+
+}  // namespace
+
+void Tally::Add(std::uint64_t value) {
+  ++count;
+  sum += value;
+  sum_sq += value * value;
+  min = std::min(min, value);
+  max = std::max(max, value);
+}
+
+double Tally::GetMean() const {
+  return count == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(count);
+}
+
+double Tally::GetStddev() const {
+  if (count == 0) return 0.0;
+  const double mean = GetMean();
+  const double variance = static_cast<double>(sum_sq) / static_cast<double>(count) - mean * mean;
+  return std::sqrt(std::max(variance, 0.0));
+}
+
+void BatchStats::Add(const WorldResult& result) {
+  ++worlds_;
+  ticks_.Add(result.ticks);
+
+  std::size_t surviving_types = 0;
+  for (const NpcType type : kTypes) {
+    surviving_types += result.survivors[Index(type)] > 0;
+  }
+  for (const NpcType type : kTypes) {
+    const std::uint64_t initial = result.initial[Index(type)];
+    const std::uint64_t survivors = result.survivors[Index(type)];
+    TypeSurvival& survival = types_[Index(type)];
+    survival.initial.Add(initial);
+    survival.survivors.Add(survivors);
+    if (initial == 0) continue;
+    survival.extinct += survivors == 0;
+    survival.wins += survivors > 0 && surviving_types == 1;
+    const std::size_t bin = static_cast<std::size_t>(survivors * kSurvivalBins / initial);
+    ++survival.histogram[std::min(bin, kSurvivalBins - 1)];
+  }
+
+  for (const NpcType winner : kTypes) {
+    for (const NpcType loser : kTypes) {
+      kills_[Index(winner)][Index(loser)].Add(result.kills[Index(winner)][Index(loser)]);
+    }
+  }
+}
+
+std::uint64_t BatchStats::GetWorldCount() const {
+  return worlds_;
+}
+
+const Tally& BatchStats::GetTicks() const {
+  return ticks_;
+}
+
+const BatchStats::TypeSurvival& BatchStats::GetSurvival(NpcType type) const {
+  return types_[Index(type)];
+}
+
+const Tally& BatchStats::GetKills(NpcType winner, NpcType loser) const {
+  return kills_[Index(winner)][Index(loser)];
+}
+
+void BatchStats::Print(std::ostream& os) const {
+  const auto flags = os.flags();
+  const auto precision = os.precision();
+  os << std::fixed << std::setprecision(2);
+  os << "Worlds: " << worlds_ << ", ticks " << ticks_.GetMean() << " +- " << ticks_.GetStddev()
+     << " (" << (worlds_ ? ticks_.min : 0) << ".." << ticks_.max << ")\n";
+
+  os << "Survivors (mean +- sd of start), extinct and sole-survivor worlds, "
+     << "worlds by surviving fraction 0-10%..90-100%:\n";
+  for (const NpcType type : kTypes) {
+    const TypeSurvival& survival = types_[Index(type)];
+    os << std::setw(8) << NpcStats::GetTypeName(type) << " " << survival.survivors.GetMean()
+       << " +- " << survival.survivors.GetStddev() << " of " << survival.initial.GetMean()
+       << ", extinct " << survival.extinct << ", wins " << survival.wins << ", [";
+    for (std::size_t bin = 0; bin < kSurvivalBins; ++bin) {
+      os << (bin ? " " : "") << survival.histogram[bin];
+    }
+    os << "]\n";
+  }
+
+  os << "Kills per world (mean +- sd, rows: winner, columns: loser)\n" << std::setw(8) << "";
+  for (const NpcType loser : kTypes) {
+    os << std::setw(16) << NpcStats::GetTypeName(loser);
+  }
+  os << "\n";
+  for (const NpcType winner : kTypes) {
+    os << std::setw(8) << NpcStats::GetTypeName(winner);
+    for (const NpcType loser : kTypes) {
+      const Tally& kills = kills_[Index(winner)][Index(loser)];
+      os << std::setw(9) << kills.GetMean() << " +- " << std::setw(4) << std::setprecision(1)
+         << kills.GetStddev() << std::setprecision(2);
+    }
+    os << "\n";
+  }
+  os.flags(flags);
+  os.precision(precision);
+}
+
+double BatchReport::GetWorldsPerSecond() const {
+  return elapsed.count() > 0 ? static_cast<double>(stats.GetWorldCount()) / elapsed.count()
+                             : 0.0;
+}
+
+BatchRunner::BatchRunner(const GameConfig& config, std::size_t world_count)
+    : config_(MakeWorldConfig(config)), world_count_(world_count), pool_(config.thread_count) {}
+
+BatchReport BatchRunner::Run(const Progress& on_world) {
+  BatchReport report;
+  std::mutex stats_mutex;
+  const std::uint64_t first_seed = config_.seed.value_or(1);
+  const auto start = std::chrono::steady_clock::now();
+
+  // Worlds vary a lot in length, so each task keeps taking the next world
+  // instead of owning a fixed range, and reuses one game for all of them.
+  std::atomic<std::size_t> next_world{0};
+  pool_.ParallelFor(pool_.GetThreadCount(), 1, [&](std::size_t, std::size_t, std::size_t) {
+    Game game(config_);
+    for (std::size_t i = next_world++; i < world_count_; i = next_world++) {
+      const WorldResult result = Simulate(game, config_, first_seed + i);
+      std::lock_guard<std::mutex> lock(stats_mutex);
+      report.stats.Add(result);
+      if (on_world) on_world(result, report.stats);
+    }
+  });
+
+  report.elapsed = std::chrono::steady_clock::now() - start;
+  return report;
+}
+
+WorldResult BatchRunner::RunWorld(const GameConfig& config, std::uint64_t seed) {
+  const GameConfig world = MakeWorldConfig(config);
+  Game game(world);
+  return Simulate(game, world, seed);
+}
+
+}  // namespace lab7
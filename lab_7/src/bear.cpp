@@ -5,8 +5,8 @@
 
 namespace lab7 {
 
-Bear::Bear(const std::string& name, int x, int y)
-    : NPC(NpcType::Bear, name, x, y) {}
+Bear::Bear(const std::string& name, int x, int y, MapBounds bounds)
+    : NPC(NpcType::Bear, name, x, y, bounds) {}
 
 bool Bear::Accept(std::shared_ptr<FightVisitor> visitor) {
   return visitor->Visit(std::dynamic_pointer_cast<Bear>(shared_from_this()));
@@ -0,0 +1,231 @@
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "checksum.hpp"
+#include "world.hpp"
+
+namespace lab7 {
+namespace {
+
+template <typename T>
+std::uint64_t ChecksumArray(std::span<const T> values, std::uint64_t hash) {
+  return Checksum(reinterpret_cast<const char*>(values.data()), values.size_bytes(), hash);
+}
+
+std::uint64_t ChecksumFrame(const CheckpointHeader& header,
+                            std::span<const CheckpointRecord> records,
+                            std::span<const EntityId> live, std::span<const EntityId> free,
+                            std::span<const EncounterTracker::Entry> cooldowns,
+                            std::string_view strings) {
+  static_assert(offsetof(CheckpointHeader, checksum) + sizeof(header.checksum) ==
+                sizeof(CheckpointHeader));
+  std::uint64_t hash = Checksum(reinterpret_cast<const char*>(&header),
+                                offsetof(CheckpointHeader, checksum), 0);
+  hash = ChecksumArray(records, hash);
+  hash = ChecksumArray(live, hash);
+  hash = ChecksumArray(free, hash);
+  hash = ChecksumArray(cooldowns, hash);
+  return Checksum(strings.data(), strings.size(), hash);
+}
+
+template <typename T>
+void WriteArray(std::ostream& os, std::span<const T> values) {
+  os.write(reinterpret_cast<const char*>(values.data()),
+           static_cast<std::streamsize>(values.size_bytes()));
+}
+
+template <typename T>
+void ReadArray(std::istream& is, std::vector<T>& values, std::uint64_t count) {
+  values.resize(static_cast<std::size_t>(count));
+  if (!is.read(reinterpret_cast<char*>(values.data()),
+               static_cast<std::streamsize>(values.size() * sizeof(T)))) {
+    throw std::runtime_error("Truncated checkpoint");
+  }
+}
+
+void CheckIds(std::span<const EntityId> ids, std::uint64_t slot_count) {
+  for (const EntityId id : ids) {
+    if (id >= slot_count) {
+      throw std::runtime_error("Checkpoint id is out of range");
+    }
+  }
+}
+
+}  // namespace
+
+CheckpointInfo CheckpointFile::Write(std::ostream& os, World& world,
+                                     const CheckpointState& state, bool full) {
+  std::vector<EntityId> ids;
+  if (full) {
+    ids.resize(world.Size());
+    std::iota(ids.begin(), ids.end(), EntityId{0});
+  } else {
+    world.GetChangedIds(ids);
+  }
+
+  std::vector<CheckpointRecord> records;
+  records.reserve(ids.size());
+  std::string strings;
+  for (const EntityId id : ids) {
+    const EntityState entity = world.GetState(id);
+    CheckpointRecord record{};
+    record.id = id;
+    record.x = entity.x;
+    record.y = entity.y;
+    record.roll_count = entity.roll_count;
+    record.generation = entity.generation;
+    record.type = entity.type;
+    record.alive = entity.alive ? 1 : 0;
+    if (entity.name.empty()) {
+      record.name_offset = kGeneratedName;
+    } else {
+      if (strings.size() + entity.name.size() > UINT32_MAX) {
+        throw std::length_error("Checkpoint string table is too large");
+      }
+      record.name_offset = static_cast<std::uint32_t>(strings.size());
+      record.name_length = static_cast<std::uint32_t>(entity.name.size());
+      strings += entity.name;
+    }
+    records.push_back(record);
+  }
+
+  const bool has_layout = full || world.IsLayoutChanged();
+  std::span<const EntityId> live;
+  std::span<const EntityId> free;
+  if (has_layout) {
+    live = world.LiveIds();
+    free = world.FreeIds();
+  }
+  const std::span<const EncounterTracker::Entry> cooldowns(state.cooldowns);
+
+  CheckpointHeader header{};
+  std::copy(std::begin(kMagic), std::end(kMagic), header.magic);
+  header.version = kVersion;
+  header.flags = (full ? kFullFrame : 0) | (has_layout ? kHasLayout : 0);
+  header.tick = state.tick;
+  header.seed = world.GetSeed();
+  header.slot_count = world.Size();
+  header.pending_dead = world.GetPendingDeadCount();
+  header.record_count = records.size();
+  header.live_count = live.size();
+  header.free_count = free.size();
+  header.cooldown_count = cooldowns.size();
+  header.string_table_size = strings.size();
+  header.checksum = ChecksumFrame(header, records, live, free, cooldowns, strings);
+
+  os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  WriteArray(os, std::span<const CheckpointRecord>(records));
+  WriteArray(os, live);
+  WriteArray(os, free);
+  WriteArray(os, cooldowns);
+  os.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+  os.flush();
+  if (!os) {
+    throw std::runtime_error("Cannot write checkpoint");
+  }
+
+  world.ClearChanges();
+  const std::size_t bytes = sizeof(header) + records.size() * sizeof(CheckpointRecord) +
+                            live.size_bytes() + free.size_bytes() + cooldowns.size_bytes() +
+                            strings.size();
+  return CheckpointInfo{full, records.size(), bytes};
+}
+
+CheckpointState CheckpointFile::Read(std::istream& is, World& world) {
+  CheckpointState state;
+  std::vector<CheckpointRecord> records;
+  std::vector<EntityId> live;
+  std::vector<EntityId> free;
+  std::string strings;
+  bool first = true;
+
+  while (is.peek() != std::istream::traits_type::eof()) {
+    CheckpointHeader header;
+    if (!is.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+      throw std::runtime_error("Truncated checkpoint");
+    }
+    if (!std::equal(std::begin(kMagic), std::end(kMagic), header.magic)) {
+      throw std::runtime_error("Not a checkpoint file");
+    }
+    if (header.version != kVersion) {
+      throw std::runtime_error("Unsupported checkpoint version");
+    }
+    const bool full = (header.flags & kFullFrame) != 0;
+    const bool has_layout = (header.flags & kHasLayout) != 0;
+    if (first && !full) {
+      throw std::runtime_error("Checkpoint does not start with a full frame");
+    }
+    if (header.slot_count > UINT32_MAX || header.record_count > header.slot_count ||
+        header.live_count + header.free_count > header.slot_count) {
+      throw std::runtime_error("Corrupt checkpoint header");
+    }
+
+    ReadArray(is, records, header.record_count);
+    ReadArray(is, live, header.live_count);
+    ReadArray(is, free, header.free_count);
+    ReadArray(is, state.cooldowns, header.cooldown_count);
+    strings.resize(static_cast<std::size_t>(header.string_table_size));
+    if (!is.read(strings.data(), static_cast<std::streamsize>(strings.size()))) {
+      throw std::runtime_error("Truncated checkpoint");
+    }
+    if (ChecksumFrame(header, records, live, free, state.cooldowns, strings) !=
+        header.checksum) {
+      throw std::runtime_error("Checkpoint checksum mismatch");
+    }
+
+    if (full) {
+      world.Clear();
+      world.Reserve(static_cast<std::size_t>(header.slot_count));
+      world.SetSeed(header.seed);
+    } else if (header.seed != world.GetSeed()) {
+      throw std::runtime_error("Checkpoint frame belongs to another run");
+    }
+
+    for (const CheckpointRecord& record : records) {
+      if (record.id >= header.slot_count) {
+        throw std::runtime_error("Checkpoint id is out of range");
+      }
+      if (record.type != NpcType::Bear && record.type != NpcType::Elf &&
+          record.type != NpcType::Robber) {
+        throw std::invalid_argument("Unknown NPC type");
+      }
+      std::string_view name;
+      if (record.name_offset != kGeneratedName) {
+        if (record.name_offset > strings.size() ||
+            record.name_length > strings.size() - record.name_offset) {
+          throw std::runtime_error("Checkpoint name is out of range");
+        }
+        name = std::string_view(strings).substr(record.name_offset, record.name_length);
+      }
+      world.SetState(record.id, EntityState{record.x, record.y, record.type, record.alive != 0,
+                                            record.roll_count, record.generation, name});
+    }
+    if (world.Size() != header.slot_count) {
+      throw std::runtime_error("Checkpoint frame does not cover every slot");
+    }
+
+    if (has_layout) {
+      CheckIds(live, header.slot_count);
+      CheckIds(free, header.slot_count);
+      world.SetLayout(live, free);
+    }
+    world.SetPendingDeadCount(static_cast<std::size_t>(header.pending_dead));
+    state.tick = header.tick;
+    first = false;
+  }
+
+  if (first) {
+    throw std::runtime_error("Empty checkpoint");
+  }
+  world.ClearChanges();
+  return state;
+}
+
+}  // namespace lab7
@@ -0,0 +1,24 @@
+#include "checksum.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace lab7 {
+
+std::uint64_t Checksum(const char* data, std::size_t size, std::uint64_t hash) {
+  constexpr std::uint64_t kMultiplier = 0x9e3779b97f4a7c15ULL;
+  std::size_t i = 0;
+  for (; i + sizeof(std::uint64_t) <= size; i += sizeof(std::uint64_t)) {
+    std::uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    hash = (std::rotl(hash, 29) ^ word) * kMultiplier;
+  }
+  if (i < size) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, data + i, size - i);
+    hash = (std::rotl(hash, 29) ^ word) * kMultiplier;
+  }
+  return hash ^ (hash >> 32);
+}
+
+}  // namespace lab7
@@ -0,0 +1,23 @@
+#include "combat_resolver.hpp"
+
+#include "fight_visitor.hpp"
+
+namespace lab7 {
+
+bool ResolveAttack(const std::shared_ptr<NPC>& attacker, const std::shared_ptr<NPC>& defender) {
+  if (!attacker || !defender || !attacker->IsAlive() || !defender->IsAlive()) {
+    return false;
+  }
+
+  const NpcType attacker_type = attacker->GetType();
+  const NpcType defender_type = defender->GetType();
+  if (attacker_type != NpcType::Unknown && defender_type != NpcType::Unknown) {
+    return ResolveAttack(attacker_type, defender_type, [&] { return attacker->RollDice(); },
+                         [&] { return defender->RollDice(); });
+  }
+
+  auto visitor = std::dynamic_pointer_cast<FightVisitor>(attacker);
+  return visitor && defender->Accept(visitor);
+}
+
+}  // namespace lab7
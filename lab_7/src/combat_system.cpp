@@ -0,0 +1,141 @@
+#include "combat_system.hpp"
+
+#include "combat_resolver.hpp"
+#include "thread_pool.hpp"
+
+namespace lab7 {
+namespace {
+
+// Stripes are wide enough that few pairs cross a border, and there are
+// enough of them to keep a pool busy on large maps.
+constexpr int kMinStripeWidth = 32;
+constexpr int kMaxStripeCount = 64;
+constexpr std::size_t kClassifyChunk = 4096;
+
+}  // namespace
+
+CombatSystem::CombatSystem(int map_size)
+    : stripe_width_(std::max(kMinStripeWidth, map_size / kMaxStripeCount + 1)),
+      stripe_count_(static_cast<std::size_t>(map_size / stripe_width_ + 1)) {}
+
+std::size_t CombatSystem::GetStripe(int x) const {
+  return std::min(static_cast<std::size_t>(std::max(x, 0) / stripe_width_), stripe_count_ - 1);
+}
+
+bool CombatSystem::IsKill(CombatOutcome outcome) {
+  return outcome == CombatOutcome::AttackerWon || outcome == CombatOutcome::DefenderWon;
+}
+
+FightResult CombatSystem::Resolve(World& world, const CombatTask& task) {
+  FightResult result{CombatOutcome::Skipped, {}};
+  if (!world.IsAlive(task.attacker) || !world.IsAlive(task.defender)) {
+    return result;
+  }
+
+  const NpcType attacker_type = world.GetType(task.attacker);
+  const NpcType defender_type = world.GetType(task.defender);
+  auto dice = [&world, &result](EntityId id, std::size_t slot) {
+    return [&world, &result, id, slot] {
+      const int roll = world.RollDice(id);
+      result.rolls[slot] = static_cast<std::uint8_t>(roll);
+      return roll;
+    };
+  };
+
+  if (ResolveAttack(attacker_type, defender_type, dice(task.attacker, 0),
+                    dice(task.defender, 1))) {
+    if (world.Kill(task.defender)) result.outcome = CombatOutcome::AttackerWon;
+    return result;
+  }
+  if (ResolveAttack(defender_type, attacker_type, dice(task.defender, 2),
+                    dice(task.attacker, 3))) {
+    if (world.Kill(task.attacker)) result.outcome = CombatOutcome::DefenderWon;
+    return result;
+  }
+  result.outcome = CombatOutcome::NoWinner;
+  return result;
+}
+
+FightRecord CombatSystem::MakeRecord(const World& world, const CombatTask& task,
+                                     const FightResult& result) {
+  return FightRecord{task.tick,
+                     task.attacker,
+                     task.defender,
+                     world.GetType(task.attacker),
+                     world.GetType(task.defender),
+                     result.outcome,
+                     result.rolls,
+                     world.GetX(task.defender),
+                     world.GetY(task.defender)};
+}
+
+void CombatSystem::ResolveBatches(World& world, std::span<const CombatTask> tasks,
+                                  ThreadPool& pool) {
+  const auto xs = world.Xs();
+  const auto live = world.LiveIds();
+  entity_stripe_.resize(world.Size());
+  pool.ParallelFor(live.size(), kClassifyChunk,
+                   [&](std::size_t, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      entity_stripe_[live[i]] = static_cast<std::uint16_t>(GetStripe(xs[live[i]]));
+    }
+  });
+
+  const std::size_t chunks = pool.GetChunkCount(tasks.size(), kClassifyChunk);
+  stripe_tasks_.resize(chunks);
+  border_tasks_.resize(chunks);
+  pool.ParallelFor(tasks.size(), kClassifyChunk,
+                   [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+    auto& stripes = stripe_tasks_[chunk];
+    auto& border = border_tasks_[chunk];
+    stripes.resize(stripe_count_);
+    for (auto& stripe : stripes) {
+      stripe.clear();
+    }
+    border.clear();
+    for (std::size_t i = begin; i < end; ++i) {
+      const CombatTask& task = tasks[i];
+      const std::uint16_t stripe = entity_stripe_[task.attacker];
+      if (stripe == entity_stripe_[task.defender]) {
+        stripes[stripe].push_back(
+            StripeTask{task.attacker, task.defender, static_cast<std::uint32_t>(i)});
+      } else {
+        border.push_back(static_cast<std::uint32_t>(i));
+      }
+    }
+  });
+
+  // Chunks are visited in order, so a stripe sees its tasks in task order.
+  results_.resize(tasks.size());
+  pool.ParallelFor(stripe_count_, 1, [&](std::size_t, std::size_t begin, std::size_t end) {
+    for (std::size_t stripe = begin; stripe < end; ++stripe) {
+      for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+        for (const StripeTask& task : stripe_tasks_[chunk][stripe]) {
+          results_[task.index] = Resolve(world, CombatTask{task.attacker, task.defender, 0});
+        }
+      }
+    }
+  });
+
+  border_count_ = 0;
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    for (const std::uint32_t task : border_tasks_[chunk]) {
+      results_[task] = Resolve(world, tasks[task]);
+    }
+    border_count_ += border_tasks_[chunk].size();
+  }
+}
+
+std::span<const FightResult> CombatSystem::Results() const {
+  return results_;
+}
+
+std::size_t CombatSystem::GetBorderCount() const {
+  return border_count_;
+}
+
+std::size_t CombatSystem::GetStripeCount() const {
+  return stripe_count_;
+}
+
+}  // namespace lab7
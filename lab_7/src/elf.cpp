@@ -5,8 +5,8 @@
 
 namespace lab7 {
 
-Elf::Elf(const std::string& name, int x, int y)
-    : NPC(NpcType::Elf, name, x, y) {}
+Elf::Elf(const std::string& name, int x, int y, MapBounds bounds)
+    : NPC(NpcType::Elf, name, x, y, bounds) {}
 
 bool Elf::Accept(std::shared_ptr<FightVisitor> visitor) {
   return visitor->Visit(std::dynamic_pointer_cast<Elf>(shared_from_this()));
@@ -0,0 +1,112 @@
+#include "encounter_tracker.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace lab7 {
+namespace {
+
+constexpr std::size_t kMinCapacity = 1024;
+
+std::uint64_t MakePairKey(EntityId a, EntityId b) {
+  const auto [low, high] = std::minmax(a, b);
+  return (static_cast<std::uint64_t>(low) << 32) | high;
+}
+
+std::size_t HashPair(std::uint64_t pair) {
+  return static_cast<std::size_t>((pair * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+}  // namespace
+
+EncounterTracker::EncounterTracker(std::uint64_t cooldown) : cooldown_(cooldown) {}
+
+bool EncounterTracker::IsExpired(const Entry& entry, std::uint64_t tick) const {
+  return entry.pair == kEmpty || entry.tick + cooldown_ < tick;
+}
+
+bool EncounterTracker::TryEngage(std::uint64_t pair, std::uint64_t tick) {
+  const std::size_t mask = table_.size() - 1;
+  std::size_t slot = HashPair(pair) & mask;
+  Entry* reusable = nullptr;
+
+  for (; table_[slot].pair != kEmpty; slot = (slot + 1) & mask) {
+    Entry& entry = table_[slot];
+    if (entry.pair == pair) {
+      if (!IsExpired(entry, tick)) return false;
+      entry.tick = tick;
+      return true;
+    }
+    if (!reusable && IsExpired(entry, tick)) reusable = &entry;
+  }
+
+  if (!reusable) {
+    reusable = &table_[slot];
+    ++used_;
+  }
+  *reusable = Entry{pair, tick};
+  return true;
+}
+
+void EncounterTracker::Rebuild(std::uint64_t tick, std::size_t incoming) {
+  Assign(GetActive(tick), incoming);
+}
+
+void EncounterTracker::Assign(std::span<const Entry> active, std::size_t incoming) {
+  const std::size_t capacity = std::max(kMinCapacity, std::bit_ceil((active.size() + incoming) * 4));
+  table_.assign(capacity, Entry{kEmpty, 0});
+  used_ = 0;
+
+  const std::size_t mask = capacity - 1;
+  for (const Entry& entry : active) {
+    std::size_t slot = HashPair(entry.pair) & mask;
+    while (table_[slot].pair != kEmpty) slot = (slot + 1) & mask;
+    table_[slot] = entry;
+    ++used_;
+  }
+}
+
+const std::vector<CombatTask>& EncounterTracker::Filter(std::span<const CombatTask> encounters,
+                                                        std::uint64_t tick) {
+  // Keep the table at most half full even if every encounter is a new pair.
+  if ((used_ + encounters.size()) * 2 > table_.size()) {
+    Rebuild(tick, encounters.size());
+  }
+
+  tasks_.clear();
+  for (const CombatTask& task : encounters) {
+    if (TryEngage(MakePairKey(task.attacker, task.defender), tick)) {
+      tasks_.push_back(task);
+    }
+  }
+  return tasks_;
+}
+
+void EncounterTracker::Clear() {
+  table_.clear();
+  used_ = 0;
+  tasks_.clear();
+}
+
+std::vector<EncounterTracker::Entry> EncounterTracker::GetActive(std::uint64_t tick) const {
+  std::vector<Entry> active;
+  for (const Entry& entry : table_) {
+    if (!IsExpired(entry, tick)) active.push_back(entry);
+  }
+  return active;
+}
+
+void EncounterTracker::Restore(std::span<const Entry> entries) {
+  Clear();
+  Assign(entries, 0);
+}
+
+std::uint64_t EncounterTracker::GetCooldown() const {
+  return cooldown_;
+}
+
+std::size_t EncounterTracker::GetTrackedPairs() const {
+  return used_;
+}
+
+}  // namespace lab7
@@ -0,0 +1,127 @@
+#include "event_bus.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "observer.hpp"
+
+namespace lab7 {
+namespace {
+
+// Keeps a list from being freed while a dispatch reads it.
+class DispatchGuard {
+ private:
+  std::atomic<std::uint32_t>& dispatching_;
+
+ public:
+  explicit DispatchGuard(std::atomic<std::uint32_t>& dispatching) : dispatching_(dispatching) {
+    dispatching_.fetch_add(1);
+  }
+  ~DispatchGuard() {
+    dispatching_.fetch_sub(1);
+  }
+
+  DispatchGuard(const DispatchGuard&) = delete;
+  DispatchGuard& operator=(const DispatchGuard&) = delete;
+};
+
+}  // namespace
+
+bool MapRegion::Contains(int x, int y) const {
+  return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+}
+
+bool FightFilter::Matches(const FightRecord& record) const {
+  if ((outcomes & GetOutcomeBit(record.outcome)) == 0) return false;
+  if ((types & (GetTypeBit(record.attacker_type) | GetTypeBit(record.defender_type))) == 0) {
+    return false;
+  }
+  return !region || region->Contains(record.x, record.y);
+}
+
+bool FightFilter::MatchesAll() const {
+  return outcomes == kAllOutcomes && types == kAllTypes && !region;
+}
+
+FightEventBus::FightEventBus() : current_(std::make_unique<List>()) {
+  list_.store(current_.get());
+}
+
+FightEventBus::~FightEventBus() = default;
+
+void FightEventBus::Replace(std::unique_ptr<List> list) {
+  list->outcomes = 0;
+  for (const Subscription& subscription : list->subscriptions) {
+    list->outcomes |= subscription.filter.outcomes;
+  }
+  list_.store(list.get());
+  retired_.push_back(std::exchange(current_, std::move(list)));
+  // Sequentially consistent with DispatchGuard: once no dispatch is
+  // running, later ones can only see the new list.
+  if (dispatching_.load() == 0) {
+    retired_.clear();
+  }
+}
+
+SubscriptionId FightEventBus::Subscribe(std::shared_ptr<IFightObserver> observer,
+                                        FightFilter filter) {
+  std::lock_guard<std::mutex> lock(update_mutex_);
+  auto list = std::make_unique<List>(*current_);
+  const SubscriptionId id = next_id_++;
+  list->subscriptions.push_back(Subscription{id, std::move(observer), filter});
+  Replace(std::move(list));
+  return id;
+}
+
+void FightEventBus::Unsubscribe(SubscriptionId id) {
+  std::lock_guard<std::mutex> lock(update_mutex_);
+  auto list = std::make_unique<List>(*current_);
+  std::erase_if(list->subscriptions,
+                [id](const Subscription& subscription) { return subscription.id == id; });
+  Replace(std::move(list));
+}
+
+void FightEventBus::Clear() {
+  std::lock_guard<std::mutex> lock(update_mutex_);
+  Replace(std::make_unique<List>());
+}
+
+std::uint8_t FightEventBus::GetOutcomeMask() const {
+  DispatchGuard guard(dispatching_);
+  return list_.load()->outcomes;
+}
+
+bool FightEventBus::IsEmpty() const {
+  DispatchGuard guard(dispatching_);
+  return list_.load()->subscriptions.empty();
+}
+
+void FightEventBus::Dispatch(std::span<const FightRecord> fights) const {
+  if (fights.empty()) return;
+  DispatchGuard guard(dispatching_);
+  const List* list = list_.load();
+
+  thread_local std::vector<FightRecord> matched;
+  for (const Subscription& subscription : list->subscriptions) {
+    if (subscription.filter.MatchesAll()) {
+      subscription.observer->OnFights(fights);
+      continue;
+    }
+    matched.clear();
+    std::copy_if(fights.begin(), fights.end(), std::back_inserter(matched),
+                 [&](const FightRecord& record) { return subscription.filter.Matches(record); });
+    if (!matched.empty()) {
+      subscription.observer->OnFights(matched);
+    }
+  }
+}
+
+void FightEventBus::Flush() const {
+  DispatchGuard guard(dispatching_);
+  for (const Subscription& subscription : list_.load()->subscriptions) {
+    subscription.observer->Flush();
+  }
+}
+
+}  // namespace lab7
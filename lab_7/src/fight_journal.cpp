@@ -0,0 +1,331 @@
+#include "fight_journal.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "checksum.hpp"
+#include "combat_system.hpp"
+#include "mapped_file.hpp"
+#include "world.hpp"
+
+namespace lab7 {
+namespace {
+
+constexpr std::uint8_t kTypeBits = 0x3;
+constexpr std::uint16_t kRollBits = 0x7;
+constexpr std::size_t kBlockAlignment = alignof(JournalIndexEntry);
+
+// Offset of the first block: the roster padded to kBlockAlignment.
+std::size_t GetDataBegin(std::size_t roster_size) {
+  const std::size_t end = sizeof(JournalHeader) + roster_size;
+  return (end + kBlockAlignment - 1) / kBlockAlignment * kBlockAlignment;
+}
+
+std::uint64_t ChecksumRecords(std::span<const JournalRecord> records, std::uint64_t first_tick) {
+  return Checksum(reinterpret_cast<const char*>(records.data()), records.size_bytes(),
+                  first_tick);
+}
+
+std::uint8_t GetTypeBit(NpcType type) {
+  return static_cast<std::uint8_t>(1U << static_cast<unsigned>(type));
+}
+
+}  // namespace
+
+bool JournalFilter::Matches(const FightRecord& record) const {
+  if (record.tick < min_tick || record.tick > max_tick) return false;
+  if (entity && record.attacker != *entity && record.defender != *entity) return false;
+  if (type && record.attacker_type != *type && record.defender_type != *type) return false;
+  return !kills_only || CombatSystem::IsKill(record.outcome);
+}
+
+bool JournalFilter::MayMatch(const JournalBlockHeader& block) const {
+  if (block.last_tick < min_tick || block.first_tick > max_tick) return false;
+  if (entity && (*entity < block.min_entity || *entity > block.max_entity)) return false;
+  return !type || (block.type_mask & GetTypeBit(*type)) != 0;
+}
+
+FightJournalWriter::FightJournalWriter(const std::string& filename, const World& world,
+                                       std::uint64_t start_tick, std::size_t block_records)
+    : out_(filename, std::ios::binary | std::ios::trunc),
+      block_records_(std::max<std::size_t>(block_records, 1)) {
+  if (!out_.is_open()) {
+    throw std::runtime_error("Cannot open file for writing: " + filename);
+  }
+
+  std::vector<std::uint8_t> roster(GetDataBegin(world.Size()) - sizeof(JournalHeader));
+  for (EntityId id = 0; id < world.Size(); ++id) {
+    roster[id] = static_cast<std::uint8_t>(static_cast<std::uint8_t>(world.GetType(id)) |
+                                           (world.IsAlive(id) ? FightJournal::kAliveBit : 0));
+  }
+
+  JournalHeader header{};
+  std::copy(std::begin(FightJournal::kMagic), std::end(FightJournal::kMagic), header.magic);
+  header.version = FightJournal::kVersion;
+  header.record_size = sizeof(JournalRecord);
+  header.start_tick = start_tick;
+  header.seed = world.GetSeed();
+  header.roster_size = world.Size();
+  out_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  // The padding after the roster stays zero.
+  out_.write(reinterpret_cast<const char*>(roster.data()),
+             static_cast<std::streamsize>(roster.size()));
+  if (!out_) {
+    throw std::runtime_error("Cannot write journal: " + filename);
+  }
+  offset_ = sizeof(header) + roster.size();
+  pending_.reserve(block_records_);
+}
+
+FightJournalWriter::~FightJournalWriter() {
+  // Errors are lost here; the blocks written so far stay readable.
+  try {
+    Close();
+  } catch (const std::exception&) {
+  }
+}
+
+void FightJournalWriter::Append(const FightRecord& record) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return;
+  AppendLocked(record);
+}
+
+void FightJournalWriter::Append(std::span<const FightRecord> records) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return;
+  for (const FightRecord& record : records) {
+    AppendLocked(record);
+  }
+}
+
+void FightJournalWriter::AppendLocked(const FightRecord& record) {
+  if (!pending_.empty()) {
+    // Tick offsets of a block must fit 32 bits.
+    const std::uint64_t first = std::min(pending_first_tick_, record.tick);
+    const std::uint64_t last = std::max(pending_last_tick_, record.tick);
+    if (last - first > UINT32_MAX) {
+      WriteBlock();
+    }
+  }
+  if (pending_.empty()) {
+    pending_first_tick_ = pending_last_tick_ = record.tick;
+  } else {
+    pending_first_tick_ = std::min(pending_first_tick_, record.tick);
+    pending_last_tick_ = std::max(pending_last_tick_, record.tick);
+  }
+  pending_.push_back(record);
+  ++record_count_;
+  if (pending_.size() >= block_records_) {
+    WriteBlock();
+  }
+}
+
+void FightJournalWriter::WriteBlock() {
+  if (pending_.empty()) return;
+
+  JournalBlockHeader block{};
+  block.first_tick = pending_first_tick_;
+  block.last_tick = pending_last_tick_;
+  block.record_count = static_cast<std::uint32_t>(pending_.size());
+  block.min_entity = UINT32_MAX;
+  encoded_.clear();
+  for (const FightRecord& record : pending_) {
+    encoded_.push_back(FightJournal::Encode(record, block.first_tick));
+    block.min_entity = std::min({block.min_entity, record.attacker, record.defender});
+    block.max_entity = std::max({block.max_entity, record.attacker, record.defender});
+    block.type_mask |= GetTypeBit(record.attacker_type) | GetTypeBit(record.defender_type);
+  }
+  block.checksum = ChecksumRecords(encoded_, block.first_tick);
+
+  out_.write(reinterpret_cast<const char*>(&block), sizeof(block));
+  out_.write(reinterpret_cast<const char*>(encoded_.data()),
+             static_cast<std::streamsize>(encoded_.size() * sizeof(JournalRecord)));
+  if (!out_) {
+    throw std::runtime_error("Cannot write journal block");
+  }
+  index_.push_back(JournalIndexEntry{offset_, block});
+  offset_ += sizeof(block) + encoded_.size() * sizeof(JournalRecord);
+  pending_.clear();
+}
+
+void FightJournalWriter::Flush() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return;
+  WriteBlock();
+  out_.flush();
+}
+
+void FightJournalWriter::Close() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_) return;
+  closed_ = true;
+  WriteBlock();
+
+  JournalFooter footer{};
+  footer.index_offset = offset_;
+  footer.block_count = index_.size();
+  std::copy(std::begin(FightJournal::kFooterMagic), std::end(FightJournal::kFooterMagic),
+            footer.magic);
+  out_.write(reinterpret_cast<const char*>(index_.data()),
+             static_cast<std::streamsize>(index_.size() * sizeof(JournalIndexEntry)));
+  out_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+  out_.close();
+  if (!out_) {
+    throw std::runtime_error("Cannot write journal index");
+  }
+}
+
+std::uint64_t FightJournalWriter::GetRecordCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return record_count_;
+}
+
+FightJournal::FightJournal(const std::string& filename)
+    : file_(std::make_unique<MappedFile>(filename)) {
+  if (file_->Size() < sizeof(JournalHeader)) {
+    throw std::runtime_error("Not a journal file: " + filename);
+  }
+
+  const char* bytes = file_->Data();
+  header_ = reinterpret_cast<const JournalHeader*>(bytes);
+  if (!std::equal(std::begin(kMagic), std::end(kMagic), header_->magic)) {
+    throw std::runtime_error("Not a journal file: " + filename);
+  }
+  if (header_->version != kVersion || header_->record_size != sizeof(JournalRecord)) {
+    throw std::runtime_error("Unsupported journal version: " + filename);
+  }
+  if (header_->roster_size > file_->Size() - sizeof(JournalHeader) ||
+      GetDataBegin(static_cast<std::size_t>(header_->roster_size)) > file_->Size()) {
+    throw std::runtime_error("Truncated journal: " + filename);
+  }
+  roster_ = {reinterpret_cast<const std::uint8_t*>(bytes + sizeof(JournalHeader)),
+             static_cast<std::size_t>(header_->roster_size)};
+
+  const std::size_t size = file_->Size();
+  const std::size_t data_begin = GetDataBegin(roster_.size());
+  if (size - data_begin >= sizeof(JournalFooter) && size % kBlockAlignment == 0) {
+    const std::size_t index_end = size - sizeof(JournalFooter);
+    const auto* footer = reinterpret_cast<const JournalFooter*>(bytes + index_end);
+    if (std::equal(std::begin(kFooterMagic), std::end(kFooterMagic), footer->magic) &&
+        footer->index_offset >= data_begin && footer->index_offset <= index_end &&
+        footer->index_offset % kBlockAlignment == 0 &&
+        footer->block_count == (index_end - footer->index_offset) / sizeof(JournalIndexEntry) &&
+        (index_end - footer->index_offset) % sizeof(JournalIndexEntry) == 0) {
+      const auto* index = reinterpret_cast<const JournalIndexEntry*>(bytes + footer->index_offset);
+      blocks_.assign(index, index + footer->block_count);
+      for (const JournalIndexEntry& entry : blocks_) {
+        if (entry.offset < data_begin || entry.offset % kBlockAlignment != 0 ||
+            footer->index_offset - entry.offset < sizeof(JournalBlockHeader) ||
+            entry.block.record_count >
+                (footer->index_offset - entry.offset - sizeof(JournalBlockHeader)) /
+                    sizeof(JournalRecord)) {
+          throw std::runtime_error("Corrupt journal index: " + filename);
+        }
+      }
+      indexed_ = true;
+      return;
+    }
+  }
+  file_->AdviseSequential();
+  ScanBlocks(size);
+}
+
+FightJournal::~FightJournal() = default;
+
+void FightJournal::ScanBlocks(std::size_t end) {
+  const char* bytes = file_->Data();
+  std::size_t offset = GetDataBegin(roster_.size());
+  // A block cut short by a crash ends the scan.
+  while (end - offset >= sizeof(JournalBlockHeader)) {
+    JournalBlockHeader block;
+    std::copy_n(bytes + offset, sizeof(block), reinterpret_cast<char*>(&block));
+    const std::size_t payload = end - offset - sizeof(block);
+    if (block.record_count == 0 || block.record_count > payload / sizeof(JournalRecord)) {
+      break;
+    }
+    blocks_.push_back(JournalIndexEntry{offset, block});
+    offset += sizeof(block) + block.record_count * sizeof(JournalRecord);
+  }
+}
+
+JournalRecord FightJournal::Encode(const FightRecord& record, std::uint64_t first_tick) {
+  JournalRecord encoded{};
+  encoded.tick_offset = static_cast<std::uint32_t>(record.tick - first_tick);
+  encoded.attacker = record.attacker;
+  encoded.defender = record.defender;
+  encoded.kinds = static_cast<std::uint8_t>(static_cast<unsigned>(record.attacker_type) |
+                                            static_cast<unsigned>(record.defender_type) << 2 |
+                                            static_cast<unsigned>(record.outcome) << 4);
+  for (std::size_t i = 0; i < record.rolls.size(); ++i) {
+    encoded.rolls |= static_cast<std::uint16_t>((record.rolls[i] & kRollBits) << (3 * i));
+  }
+  return encoded;
+}
+
+FightRecord FightJournal::Decode(const JournalRecord& record, std::uint64_t first_tick) {
+  FightRecord decoded{first_tick + record.tick_offset,
+                      record.attacker,
+                      record.defender,
+                      static_cast<NpcType>(record.kinds & kTypeBits),
+                      static_cast<NpcType>(record.kinds >> 2 & kTypeBits),
+                      static_cast<CombatOutcome>(record.kinds >> 4 & kTypeBits),
+                      {}};
+  for (std::size_t i = 0; i < decoded.rolls.size(); ++i) {
+    decoded.rolls[i] = static_cast<std::uint8_t>(record.rolls >> (3 * i) & kRollBits);
+  }
+  return decoded;
+}
+
+std::uint64_t FightJournal::GetStartTick() const {
+  return header_->start_tick;
+}
+
+std::uint64_t FightJournal::GetSeed() const {
+  return header_->seed;
+}
+
+bool FightJournal::IsIndexed() const {
+  return indexed_;
+}
+
+std::span<const std::uint8_t> FightJournal::Roster() const {
+  return roster_;
+}
+
+std::span<const JournalIndexEntry> FightJournal::Blocks() const {
+  return blocks_;
+}
+
+std::span<const JournalRecord> FightJournal::Records(const JournalIndexEntry& entry) const {
+  const char* bytes = file_->Data();
+  const std::span<const JournalRecord> records(
+      reinterpret_cast<const JournalRecord*>(bytes + entry.offset + sizeof(JournalBlockHeader)),
+      entry.block.record_count);
+  if (ChecksumRecords(records, entry.block.first_tick) != entry.block.checksum) {
+    throw std::runtime_error("Journal block checksum mismatch");
+  }
+  return records;
+}
+
+std::vector<bool> FightJournal::ReplayAlive(std::uint64_t tick) const {
+  std::vector<bool> alive(roster_.size());
+  for (std::size_t id = 0; id < roster_.size(); ++id) {
+    alive[id] = (roster_[id] & kAliveBit) != 0;
+  }
+
+  JournalFilter filter;
+  filter.max_tick = tick;
+  filter.kills_only = true;
+  ForEach(filter, [&alive](const FightRecord& record) {
+    const EntityId loser =
+        record.outcome == CombatOutcome::AttackerWon ? record.defender : record.attacker;
+    if (loser >= alive.size()) {
+      throw std::runtime_error("Journal entity is out of range");
+    }
+    alive[loser] = false;
+  });
+  return alive;
+}
+
+}  // namespace lab7
@@ -0,0 +1,206 @@
+#include "fight_log.hpp"
+
+#include <string_view>
+#include <utility>
+
+#include "combat_system.hpp"
+#include "npc_types.hpp"
+#include "thread_local_cache.hpp"
+
+namespace lab7 {
+namespace {
+
+constexpr std::string_view kMurderPrefix = "MURDER: ";
+constexpr std::string_view kFightPrefix = "FIGHT: ";
+
+std::atomic<std::uint64_t> next_log_id{0};
+
+}  // namespace
+
+AsyncFightLog::AsyncFightLog(std::ostream& out, NameLookup names,
+                             std::chrono::milliseconds flush_interval, std::mutex* out_mutex)
+    : out_(out),
+      out_mutex_(out_mutex),
+      names_(std::move(names)),
+      flush_interval_(flush_interval),
+      id_(next_log_id++),
+      stop_(false),
+      flush_requests_(0),
+      flushes_done_(0),
+      written_(0),
+      dropped_(0),
+      writer_(&AsyncFightLog::WriterLoop, this) {}
+
+AsyncFightLog::~AsyncFightLog() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_cv_.notify_all();
+  writer_.join();
+}
+
+AsyncFightLog::Stream::Stream() : head(new Block()), tail(head) {}
+
+AsyncFightLog::Stream::~Stream() {
+  while (head) {
+    delete std::exchange(head, head->next.load(std::memory_order_relaxed));
+  }
+}
+
+AsyncFightLog::Stream& AsyncFightLog::LocalStream() {
+  return ThreadLocalFor<Stream>(id_, [this]() -> Stream& {
+    std::lock_guard<std::mutex> lock(streams_mutex_);
+    streams_.push_back(std::make_unique<Stream>());
+    return *streams_.back();
+  });
+}
+
+void AsyncFightLog::Push(const FightRecord& record) {
+  Push(LocalStream(), record);
+}
+
+void AsyncFightLog::Push(std::span<const FightRecord> records) {
+  Stream& stream = LocalStream();
+  for (const FightRecord& record : records) {
+    Push(stream, record);
+  }
+}
+
+void AsyncFightLog::Push(Stream& stream, const FightRecord& record) {
+  Block* block = stream.tail;
+  std::size_t count = block->count.load(std::memory_order_relaxed);
+
+  if (count == kBlockSize) {
+    if (stream.pending_blocks.load(std::memory_order_relaxed) >= kMaxPendingBlocks) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    Block* next = new Block();
+    stream.pending_blocks.fetch_add(1, std::memory_order_relaxed);
+    block->next.store(next, std::memory_order_release);
+    stream.tail = block = next;
+    count = 0;
+    // Pushing stays lock-free, so the writer may miss this notification
+    // while it goes to sleep; it then drains at the end of the interval.
+    full_blocks_.fetch_add(1, std::memory_order_relaxed);
+    wake_cv_.notify_one();
+  }
+
+  block->records[count] = record;
+  block->count.store(count + 1, std::memory_order_release);
+}
+
+void AsyncFightLog::PushLine(std::string line) {
+  std::lock_guard<std::mutex> lock(streams_mutex_);
+  lines_.push_back(std::move(line));
+}
+
+void AsyncFightLog::Flush() {
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  const std::uint64_t target = ++flush_requests_;
+  wake_cv_.notify_all();
+  flushed_cv_.wait(lock, [this, target] { return flushes_done_ >= target; });
+}
+
+std::uint64_t AsyncFightLog::GetWritten() const {
+  return written_.load(std::memory_order_relaxed);
+}
+
+std::uint64_t AsyncFightLog::GetDropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void AsyncFightLog::WriterLoop() {
+  std::string buffer;
+  while (true) {
+    std::uint64_t requested = 0;
+    bool stopping = false;
+    {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_cv_.wait_for(lock, flush_interval_, [this] {
+        return stop_ || flush_requests_ > flushes_done_ ||
+               full_blocks_.load(std::memory_order_relaxed) > 0;
+      });
+      full_blocks_.store(0, std::memory_order_relaxed);
+      requested = flush_requests_;
+      stopping = stop_;
+    }
+
+    Drain(buffer);
+    if (!buffer.empty()) {
+      std::unique_lock<std::mutex> out_lock;
+      if (out_mutex_) {
+        out_lock = std::unique_lock<std::mutex>(*out_mutex_);
+      }
+      out_.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      out_.flush();
+      buffer.clear();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      flushes_done_ = requested;
+    }
+    flushed_cv_.notify_all();
+    if (stopping) return;
+  }
+}
+
+void AsyncFightLog::Drain(std::string& buffer) {
+  std::lock_guard<std::mutex> lock(streams_mutex_);
+  for (auto& stream : streams_) {
+    while (true) {
+      Block* block = stream->head;
+      const std::size_t count = block->count.load(std::memory_order_acquire);
+      for (std::size_t i = stream->consumed; i < count; ++i) {
+        Format(block->records[i], buffer);
+      }
+      written_.fetch_add(count - stream->consumed, std::memory_order_relaxed);
+      stream->consumed = count;
+
+      Block* next = block->next.load(std::memory_order_acquire);
+      if (count < kBlockSize || !next) break;
+      stream->head = next;
+      stream->consumed = 0;
+      stream->pending_blocks.fetch_sub(1, std::memory_order_relaxed);
+      delete block;
+    }
+  }
+  for (auto& line : lines_) {
+    buffer += line;
+    buffer += '\n';
+  }
+  written_.fetch_add(lines_.size(), std::memory_order_relaxed);
+  lines_.clear();
+}
+
+void AsyncFightLog::Format(const FightRecord& record, std::string& buffer) const {
+  auto name = [this](EntityId id) {
+    return names_ ? names_(id) : std::string(1, '#').append(std::to_string(id));
+  };
+  if (!CombatSystem::IsKill(record.outcome)) {
+    buffer += kFightPrefix;
+    buffer += NpcStats::GetTypeName(record.attacker_type);
+    buffer += " \"";
+    buffer += name(record.attacker);
+    buffer += "\" vs ";
+    buffer += NpcStats::GetTypeName(record.defender_type);
+    buffer += " \"";
+    buffer += name(record.defender);
+    buffer += record.outcome == CombatOutcome::NoWinner ? "\": no winner\n" : "\": skipped\n";
+    return;
+  }
+  const bool attacker_won = record.outcome == CombatOutcome::AttackerWon;
+  buffer += kMurderPrefix;
+  buffer += NpcStats::GetTypeName(attacker_won ? record.attacker_type : record.defender_type);
+  buffer += " \"";
+  buffer += name(attacker_won ? record.attacker : record.defender);
+  buffer += "\" killed ";
+  buffer += NpcStats::GetTypeName(attacker_won ? record.defender_type : record.attacker_type);
+  buffer += " \"";
+  buffer += name(attacker_won ? record.defender : record.attacker);
+  buffer += "\"\n";
+}
+
+}  // namespace lab7
@@ -1,233 +1,559 @@
 #include "game.hpp"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
-#include <cmath>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <numeric>
 #include <random>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
 #include <thread>
+#include <utility>
+#include <vector>
 
-#include "fight_visitor.hpp"
 #include "npc_factory.hpp"
+#include "npc_types.hpp"
 #include "observer.hpp"
+#include "rng.hpp"
 
 namespace lab7 {
 namespace {
 
-std::random_device rd;
-std::mt19937 gen(rd());
-std::uniform_int_distribution<> coord_dist(0, 100);
-std::uniform_int_distribution<> type_dist(1, 3);
+constexpr std::string_view kRecordingHeader = "lab7-recording";
+
+GameConfig MakeConfig(size_t thread_count, int map_size) {
+  GameConfig config;
+  config.thread_count = thread_count;
+  config.map_size = map_size;
+  return config;
+}
+
+Counter GetCounter(CombatOutcome outcome) {
+  switch (outcome) {
+    case CombatOutcome::Skipped:
+      return Counter::CombatSkipped;
+    case CombatOutcome::NoWinner:
+      return Counter::NoWinner;
+    case CombatOutcome::AttackerWon:
+    case CombatOutcome::DefenderWon:
+      return Counter::Kills;
+  }
+  return Counter::CombatSkipped;
+}
 
 }  // namespace
 
-Game::Game() : running_(false) {}
+Game::Game(size_t thread_count, int map_size) : Game(MakeConfig(thread_count, map_size)) {}
+
+Game::Game(const GameConfig& config)
+    : Game(config, std::make_shared<Scheduler>(config.worker_threads)) {}
+
+Game::Game(const GameConfig& config, std::shared_ptr<Scheduler> scheduler)
+    : combat_queue_(kCombatQueueCapacity),
+      running_(false),
+      tick_(0),
+      scheduler_(std::move(scheduler)),
+      stop_event_(*scheduler_),
+      combat_ready_(*scheduler_),
+      stages_([this] { Stop(); }),
+      config_(config),
+      pool_(config.thread_count),
+      movement_(config.map_size),
+      encounters_(config.combat_cooldown.value_or(0)),
+      combat_(config.map_size) {
+  // CombatSystem::Resolve() tries both directions, so one task per pair is enough.
+  movement_.SetUniquePairs(config.combat_cooldown.has_value());
+}
 
 Game::~Game() {
   Stop();
+  if (started_) {
+    scheduler_->RunUntilDone(stages_);
+  }
+}
+
+const GameConfig& Game::GetConfig() const {
+  return config_;
+}
+
+void Game::SetHeadless(bool headless) {
+  config_.headless = headless;
+}
+
+SubscriptionId Game::Subscribe(std::shared_ptr<IFightObserver> observer, FightFilter filter) {
+  return events_.Subscribe(std::move(observer), filter);
+}
+
+void Game::Unsubscribe(SubscriptionId id) {
+  events_.Unsubscribe(id);
 }
 
 void Game::Initialize(int npc_count) {
-  std::unique_lock<std::shared_mutex> lock(npcs_mutex_);
+  std::random_device rd;
+  Initialize(npc_count, (static_cast<std::uint64_t>(rd()) << 32) | rd());
+}
+
+void Game::Initialize(int npc_count, std::uint64_t seed) {
+  std::unique_lock<std::shared_mutex> lock(world_mutex_);
   
-  npcs_.clear();
-  npcs_.reserve(npc_count);
+  Reset(seed, npc_count);
   
-  auto console_obs = std::make_shared<ConsoleObserver>();
-  auto file_obs = std::make_shared<FileObserver>("log.txt");
+  std::vector<std::uint32_t> ids(static_cast<size_t>(std::max(npc_count, 0)));
+  std::iota(ids.begin(), ids.end(), 0U);
+  std::vector<RandomBlock> blocks(ids.size());
+  FillRandomBlocks(seed, RngStream::Spawn, ids, 0, blocks);
   
-  for (int i = 0; i < npc_count; ++i) {
-    auto type = static_cast<NpcType>(type_dist(gen));
-    std::string name = "NPC" + std::to_string(i);
-    int x = coord_dist(gen);
-    int y = coord_dist(gen);
+  for (const RandomBlock& block : blocks) {
+    auto type = static_cast<NpcType>(CounterRng::ToInt(block[0], 1, 3));
+    int x = CounterRng::ToInt(block[1], 0, config_.map_size);
+    int y = CounterRng::ToInt(block[2], 0, config_.map_size);
     
-    auto npc = NpcFactory::CreateNPC(type, name, x, y);
-    npc->Subscribe(console_obs);
-    npc->Subscribe(file_obs);
-    npcs_.push_back(npc);
+    world_.Add(type, x, y);
+  }
+  OpenJournal();
+  frames_.Publish(world_, 0);
+}
+
+void Game::Reset(std::uint64_t seed, size_t capacity) {
+  // Observers and frame readers look names up in the world, so they go first.
+  events_.Clear();
+  frames_.Clear();
+  journal_.reset();
+  
+  world_.Clear();
+  world_.SetBounds(config_.GetBounds());
+  world_.Reserve(capacity);
+  world_.SetSeed(seed);
+  tick_ = 0;
+  encounters_.Clear();
+  metrics_.Reset();
+  checkpoint_path_.clear();
+  
+  if (config_.headless) return;
+  auto names = [this](EntityId id) { return world_.GetName(id); };
+  events_.Subscribe(std::make_shared<ConsoleObserver>(names));
+  events_.Subscribe(std::make_shared<FileObserver>("log.txt", names));
+}
+
+void Game::OpenJournal() {
+  if (!config_.journal_file.empty()) {
+    journal_ = std::make_unique<FightJournalWriter>(config_.journal_file, world_, tick_);
+  }
+}
+
+void Game::CompactWorld(MetricsShard& metrics) {
+  // The live list only changes under the exclusive lock, so the cheap check
+  // can run under the shared one; kills in between only add to the count.
+  {
+    std::shared_lock<std::shared_mutex> lock(world_mutex_);
+    if (!world_.ShouldCompact()) return;
   }
+  // Combat batches and printers iterate the live list under the shared lock.
+  std::unique_lock<std::shared_mutex> lock(world_mutex_);
+  metrics.Add(Counter::EntitiesCompacted, world_.Compact());
 }
 
-void Game::MovementThread() {
-  std::random_device rd_local;
-  std::mt19937 gen_local(rd_local());
-  std::uniform_int_distribution<> move_dist(-1, 1);
+const std::vector<CombatTask>& Game::AdvanceTick(MetricsShard& metrics) {
+  ScopedTimer timer(metrics, Histogram::MovementTickNs);
+  const std::uint64_t tick = tick_++;
+  movement_.Move(world_, tick, pool_);
+  const auto& encounters = movement_.Detect(world_, tick, pool_);
+  metrics.Add(Counter::Ticks);
+  metrics.Add(Counter::EntityUpdates, movement_.GetAliveCount());
+  if (config_.combat_cooldown.value_or(0) == 0) {
+    metrics.Add(Counter::CombatTasks, encounters.size());
+    return encounters;
+  }
+  
+  const auto& tasks = encounters_.Filter(encounters, tick);
+  metrics.Add(Counter::EncountersOnCooldown, encounters.size() - tasks.size());
+  metrics.Add(Counter::CombatTasks, tasks.size());
+  return tasks;
+}
+
+Task Game::MovementStage() {
+  const bool unlimited = config_.tick_rate == GameConfig::kUnlimitedTickRate;
+  const auto period = unlimited ? std::chrono::steady_clock::duration::zero()
+                                : std::chrono::steady_clock::duration(std::chrono::seconds(1)) /
+                                      config_.tick_rate;
+  auto next_tick = std::chrono::steady_clock::now();
   
   while (running_) {
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (config_.tick_budget > 0 && tick_ >= config_.tick_budget) {
+      Stop();
+      break;
+    }
+    if (!unlimited) {
+      next_tick += period;
+      if (co_await stop_event_.WaitUntil(next_tick)) break;
+    }
     
-    std::shared_lock<std::shared_mutex> read_lock(npcs_mutex_);
-    auto npcs_copy = npcs_;
+    // The coroutine may resume on another thread, so the metrics shard is
+    // looked up again after every suspension.
+    MetricsShard* metrics = &metrics_.Local();
+    CompactWorld(*metrics);
+    std::shared_lock<std::shared_mutex> read_lock(world_mutex_);
+    const auto& encounters = AdvanceTick(*metrics);
+    PublishFrame(*metrics);
     read_lock.unlock();
     
-    for (auto& npc : npcs_copy) {
-      if (!npc->IsAlive()) continue;
-      
-      int move_dist = npc->GetMoveDistance();
-      int current_x = npc->GetX();
-      int current_y = npc->GetY();
-      
-      std::uniform_real_distribution<double> angle_dist(0.0, 2.0 * 3.14159265359);
-      double angle = angle_dist(gen_local);
-      
-      int new_x = current_x + static_cast<int>(move_dist * std::cos(angle));
-      int new_y = current_y + static_cast<int>(move_dist * std::sin(angle));
-      
-      npc->Move(new_x, new_y);
-      
-      if (!npc->IsAlive()) continue;
-      
-      int kill_dist = npc->GetKillDistance();
-      
-      for (auto& other : npcs_copy) {
-        if (npc == other) continue;
-        if (!other->IsAlive()) continue;
-        if (!npc->IsAlive()) break;
-        
-        if (npc->IsClose(other, kill_dist)) {
-          CombatTask task;
-          task.attacker = npc;
-          task.defender = other;
-          
-          {
-            std::lock_guard<std::mutex> queue_lock(combat_queue_mutex_);
-            if (combat_queue_.size() < 500) {
-              combat_queue_.push(task);
-              combat_queue_cv_.notify_one();
-            }
-          }
-        }
-      }
+    // Without a tick rate to keep, let the combat stage drain the queue
+    // instead of dropping tasks, so throughput reflects the whole pipeline.
+    const std::span<const CombatTask> tasks(encounters);
+    size_t pushed = combat_queue_.TryPushBatch(tasks);
+    combat_ready_.Set();
+    while (unlimited && pushed < tasks.size() && running_) {
+      co_await scheduler_->Yield();
+      pushed += combat_queue_.TryPushBatch(tasks.subspan(pushed));
+      combat_ready_.Set();
+    }
+    metrics = &metrics_.Local();
+    metrics->Add(Counter::TasksDropped, tasks.size() - pushed);
+    metrics->Record(Histogram::QueueDepth, combat_queue_.SizeApprox());
+    if (unlimited) {
+      co_await scheduler_->Yield();
     }
   }
 }
 
-void Game::CombatThread() {
-  while (running_) {
-    std::unique_lock<std::mutex> queue_lock(combat_queue_mutex_);
-    combat_queue_cv_.wait(queue_lock, [this] { 
-      return !combat_queue_.empty() || !running_; 
-    });
-    
-    if (!running_ && combat_queue_.empty()) break;
-    
-    if (combat_queue_.empty()) continue;
-    
-    CombatTask task = combat_queue_.front();
-    combat_queue_.pop();
-    queue_lock.unlock();
-    
-    bool attacker_alive = task.attacker->IsAlive();
-    bool defender_alive = task.defender->IsAlive();
-    
-    if (!attacker_alive || !defender_alive) {
+Task Game::CombatStage() {
+  std::array<CombatTask, kCombatBatchSize> batch;
+  std::vector<FightRecord> fights;
+  fights.reserve(kCombatBatchSize);
+  
+  while (true) {
+    // Reset before popping: a push after the pop sets the event again, and
+    // Stop() clears running_ before setting it.
+    combat_ready_.Reset();
+    if (!running_) break;
+    const size_t count = combat_queue_.PopBatch(batch);
+    if (count == 0) {
+      co_await combat_ready_.Wait();
       continue;
     }
-    
-    auto attacker_visitor = std::dynamic_pointer_cast<FightVisitor>(task.attacker);
-    bool defender_killed = false;
-    if (attacker_visitor && task.defender->Accept(attacker_visitor)) {
-      task.defender->Kill();
-      defender_killed = true;
-      task.attacker->FightNotify(task.attacker, task.defender, true);
-      
-      {
-        std::lock_guard<std::mutex> cout_lock(cout_mutex_);
-        std::cout << "COMBAT: " << task.attacker->GetName() 
-                  << " killed " << task.defender->GetName() << std::endl;
-      }
-    }
-    
-    if (task.attacker->IsAlive() && !defender_killed) {
-      auto defender_visitor = std::dynamic_pointer_cast<FightVisitor>(task.defender);
-      if (defender_visitor && task.defender->IsAlive() && task.attacker->Accept(defender_visitor)) {
-        task.attacker->Kill();
-        task.defender->FightNotify(task.defender, task.attacker, true);
-        
-        {
-          std::lock_guard<std::mutex> cout_lock(cout_mutex_);
-          std::cout << "COMBAT: " << task.defender->GetName() 
-                    << " killed " << task.attacker->GetName() << std::endl;
+    ResolveCombatBatch(std::span<const CombatTask>(batch.data(), count), fights);
+    co_await scheduler_->Yield();
+  }
+}
+
+void Game::ResolveCombatBatch(std::span<const CombatTask> tasks,
+                              std::vector<FightRecord>& fights) {
+  MetricsShard& metrics = metrics_.Local();
+  ScopedTimer timer(metrics, Histogram::CombatBatchNs);
+  std::shared_lock<std::shared_mutex> world_lock(world_mutex_);
+  const std::uint8_t recorded = GetRecordedOutcomes();
+  auto record = [&](const FightRecord& fight) {
+    if (recorded & FightFilter::GetOutcomeBit(fight.outcome)) fights.push_back(fight);
+  };
+  fights.clear();
+  for (const CombatTask& task : tasks) {
+    metrics.Add(GetCounter(CombatSystem::ResolveClaimed(world_, task, record)));
+  }
+  PublishFights(fights);
+}
+
+void Game::Step(std::uint64_t ticks) {
+  MetricsShard& metrics = metrics_.Local();
+  
+  for (std::uint64_t i = 0; i < ticks; ++i) {
+    CompactWorld(metrics);
+    std::shared_lock<std::shared_mutex> lock(world_mutex_);
+    const auto& encounters = AdvanceTick(metrics);
+    {
+      ScopedTimer timer(metrics, Histogram::CombatBatchNs);
+      combat_.ResolveBatches(world_, encounters, pool_);
+      // Fights are reported in task order, whatever thread resolved them.
+      const auto results = combat_.Results();
+      const std::uint8_t recorded = GetRecordedOutcomes();
+      tick_fights_.clear();
+      for (size_t task = 0; task < results.size(); ++task) {
+        const CombatOutcome outcome = results[task].outcome;
+        metrics.Add(GetCounter(outcome));
+        if (recorded & FightFilter::GetOutcomeBit(outcome)) {
+          tick_fights_.push_back(
+              CombatSystem::MakeRecord(world_, encounters[task], results[task]));
         }
       }
+      PublishFights(tick_fights_);
     }
+    PublishFrame(metrics);
+  }
+}
+
+void Game::PublishFrame(MetricsShard& metrics) {
+  if (!frames_.Publish(world_, tick_)) {
+    metrics.Add(Counter::FramesSkipped);
+  }
+}
+
+std::uint64_t Game::GetTick() const {
+  return tick_;
+}
+
+std::uint64_t Game::GetSeed() const {
+  std::shared_lock<std::shared_mutex> lock(world_mutex_);
+  return world_.GetSeed();
+}
+
+void Game::SaveRecording(const std::string& filename, std::uint64_t ticks) const {
+  std::ofstream ofs(filename);
+  if (!ofs.is_open()) {
+    throw std::runtime_error("Cannot open file for writing: " + filename);
+  }
+  
+  std::shared_lock<std::shared_mutex> lock(world_mutex_);
+  ofs << kRecordingHeader << " " << world_.GetSeed() << " " << ticks << std::endl;
+  ofs << world_.Size() << std::endl;
+  for (EntityId id = 0; id < world_.Size(); ++id) {
+    ofs << static_cast<int>(world_.GetType(id)) << " " << world_.GetName(id) << " "
+        << world_.GetX(id) << " " << world_.GetY(id) << std::endl;
+  }
+}
+
+std::uint64_t Game::LoadRecording(const std::string& filename) {
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Cannot open file for reading: " + filename);
+  }
+  
+  std::string header;
+  std::uint64_t seed = 0;
+  std::uint64_t ticks = 0;
+  if (!(ifs >> header >> seed >> ticks) || header != kRecordingHeader) {
+    throw std::runtime_error("Not a recording file: " + filename);
+  }
+  
+  auto roster = NpcFactory::LoadFromStream(ifs, config_.GetBounds());
+  
+  std::unique_lock<std::shared_mutex> lock(world_mutex_);
+  Reset(seed, roster.size());
+  
+  for (const auto& npc : roster) {
+    world_.Add(npc->GetType(), npc->GetX(), npc->GetY(), npc->GetName());
+  }
+  OpenJournal();
+  frames_.Publish(world_, 0);
+  return ticks;
+}
+
+CheckpointInfo Game::Checkpoint(const std::string& filename) {
+  if (running_) {
+    throw std::logic_error("Cannot checkpoint a running game");
   }
+  
+  std::unique_lock<std::shared_mutex> lock(world_mutex_);
+  const bool full = filename != checkpoint_path_;
+  std::ofstream ofs(filename, std::ios::binary | (full ? std::ios::trunc : std::ios::app));
+  if (!ofs.is_open()) {
+    throw std::runtime_error("Cannot open file for writing: " + filename);
+  }
+  
+  const std::uint64_t tick = tick_;
+  const CheckpointInfo info = CheckpointFile::Write(
+      ofs, world_, CheckpointState{tick, encounters_.GetActive(tick)}, full);
+  checkpoint_path_ = filename;
+  return info;
 }
 
-void Game::MainThread() {
-  auto start_time = std::chrono::steady_clock::now();
+void Game::Restore(const std::string& filename) {
+  if (running_) {
+    throw std::logic_error("Cannot restore a running game");
+  }
+  
+  std::ifstream ifs(filename, std::ios::binary);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Cannot open file for reading: " + filename);
+  }
   
+  std::unique_lock<std::shared_mutex> lock(world_mutex_);
+  Reset(0, 0);
+  const CheckpointState state = CheckpointFile::Read(ifs, world_);
+  encounters_.Restore(state.cooldowns);
+  tick_ = state.tick;
+  OpenJournal();
+  frames_.Publish(world_, state.tick);
+  checkpoint_path_ = filename;
+}
+
+Task Game::RenderStage() {
   while (running_) {
-    auto current_time = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
-        current_time - start_time).count();
-    
-    if (elapsed >= GAME_DURATION_SECONDS) {
-      running_ = false;
-      break;
+    if (!config_.headless) {
+      PrintMap();
     }
+    DumpMetrics();
     
-    PrintMap();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    const auto next_frame = std::chrono::steady_clock::now() + config_.render_interval;
+    if (co_await stop_event_.WaitUntil(next_frame)) break;
   }
   
-  {
-    std::lock_guard<std::mutex> cout_lock(cout_mutex_);
-    std::cout << "\n=== Game Over ===" << std::endl;
-    auto survivors = GetAliveNPCs();
-    std::cout << "Survivors: " << survivors.size() << std::endl;
-    for (const auto& npc : survivors) {
-      std::cout << "  " << *npc << std::endl;
-    }
+  if (!config_.headless) {
+    PrintSurvivors();
+  }
+}
+
+Task Game::TimerStage() {
+  if (config_.duration <= std::chrono::milliseconds::zero()) co_return;
+  const auto deadline = std::chrono::steady_clock::now() + config_.duration;
+  if (!co_await stop_event_.WaitUntil(deadline)) {
+    Stop();
   }
 }
 
 void Game::Run() {
+  Start();
+  Wait();
+}
+
+void Game::Start() {
+  if (started_) {
+    throw std::logic_error("Game is already running");
+  }
+  started_ = true;
   running_ = true;
+  stop_event_.Reset();
+  combat_ready_.Reset();
   
-  std::thread movement_thread(&Game::MovementThread, this);
-  std::thread combat_thread(&Game::CombatThread, this);
-  std::thread main_thread(&Game::MainThread, this);
-  
-  main_thread.join();
-  running_ = false;
-  combat_queue_cv_.notify_all();
+  scheduler_->Spawn(MovementStage(), stages_);
+  for (size_t i = 0; i < config_.combat_threads; ++i) {
+    scheduler_->Spawn(CombatStage(), stages_);
+  }
+  scheduler_->Spawn(RenderStage(), stages_);
+  scheduler_->Spawn(TimerStage(), stages_);
+}
+
+void Game::Wait() {
+  if (!started_) return;
+  scheduler_->RunUntilDone(stages_);
+  started_ = false;
+  if (const auto error = stages_.TakeError()) {
+    std::rethrow_exception(error);
+  }
   
-  movement_thread.join();
-  combat_thread.join();
+  if (journal_) {
+    journal_->Flush();
+  }
+  DumpMetrics();
 }
 
 void Game::Stop() {
   running_ = false;
-  combat_queue_cv_.notify_all();
+  stop_event_.Set();
+  combat_ready_.Set();
+}
+
+QueueStats Game::GetCombatQueueStats() const {
+  return combat_queue_.GetStats();
+}
+
+MetricsSnapshot Game::GetMetrics() const {
+  MetricsSnapshot snapshot = metrics_.Snapshot();
+  snapshot.combat_queue = combat_queue_.GetStats();
+  return snapshot;
+}
+
+void Game::SetMetricsDump(const std::string& filename, MetricsFormat format) {
+  config_.metrics_file = filename;
+  config_.metrics_format = format;
+}
+
+void Game::SetJournal(const std::string& filename) {
+  config_.journal_file = filename;
+}
+
+void Game::DumpMetrics() const {
+  if (config_.metrics_file.empty()) return;
+  // A failed dump loses one sample; the run itself goes on.
+  try {
+    WriteMetricsFile(GetMetrics(), config_.metrics_format, config_.metrics_file);
+  } catch (const std::exception& e) {
+    std::cerr << "Metrics: " << e.what() << std::endl;
+  }
+}
+
+std::shared_ptr<NPC> Game::MakeHandle(EntityId id) const {
+  // The handle reads its position from the world once bound.
+  auto npc = NpcFactory::CreateNPC(world_.GetType(id), world_.GetName(id), 0, 0, handle_pool_);
+  npc->Bind(const_cast<World&>(world_), id);
+  return npc;
+}
+
+std::uint8_t Game::GetRecordedOutcomes() const {
+  const std::uint8_t fought = static_cast<std::uint8_t>(
+      ~FightFilter::GetOutcomeBit(CombatOutcome::Skipped));
+  return journal_ ? fought : events_.GetOutcomeMask() & fought;
+}
+
+void Game::PublishFights(std::span<const FightRecord> fights) const {
+  if (journal_) {
+    journal_->Append(fights);
+  }
+  events_.Dispatch(fights);
+}
+
+void Game::PrintEntity(std::ostream& os, EntityId id) const {
+  os << NpcStats::GetTypeName(world_.GetType(id)) << " \"" << world_.GetName(id)
+     << "\" at (" << world_.GetX(id) << ", " << world_.GetY(id) << ")";
+}
+
+FrameView Game::GetSnapshot() const {
+  return frames_.Acquire();
 }
 
 std::vector<std::shared_ptr<NPC>> Game::GetAliveNPCs() const {
-  std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
+  const FrameView frame = frames_.Acquire();
   std::vector<std::shared_ptr<NPC>> alive;
+  alive.reserve(frame->Size());
   
-  for (const auto& npc : npcs_) {
-    if (npc->IsAlive()) {
-      alive.push_back(npc);
-    }
+  for (const auto& entry : frame->Entries()) {
+    alive.push_back(MakeHandle(entry.id));
   }
   
   return alive;
 }
 
-void Game::PrintMap() const {
+void Game::PrintSurvivors() const {
+  events_.Flush();
+  
   std::lock_guard<std::mutex> cout_lock(cout_mutex_);
+  std::cout << "\n=== Game Over ===" << std::endl;
   
-  std::cout << "\n=== Map ===" << std::endl;
+  std::shared_lock<std::shared_mutex> lock(world_mutex_);
+  size_t survivors = 0;
+  for (const EntityId id : world_.LiveIds()) {
+    survivors += world_.IsAlive(id);
+  }
+  std::cout << "Survivors: " << survivors << std::endl;
+  for (const EntityId id : world_.LiveIds()) {
+    if (world_.IsAlive(id)) {
+      std::cout << "  ";
+      PrintEntity(std::cout, id);
+      std::cout << std::endl;
+    }
+  }
+}
+
+void Game::PrintMap() const {
+  MetricsShard& metrics = metrics_.Local();
+  ScopedTimer timer(metrics, Histogram::RenderNs);
+  metrics.Add(Counter::Frames);
   
-  std::shared_lock<std::shared_mutex> lock(npcs_mutex_);
-  for (const auto& npc : npcs_) {
-    if (npc->IsAlive()) {
-      std::cout << *npc << std::endl;
+  std::ostringstream out;
+  out << "\n=== Map ===\n";
+  {
+    const FrameView frame = frames_.Acquire();
+    for (const auto& entry : frame->Entries()) {
+      out << NpcStats::GetTypeName(entry.type) << " \"" << frame->GetName(entry.id)
+          << "\" at (" << entry.x << ", " << entry.y << ")\n";
     }
   }
+  
+  std::lock_guard<std::mutex> cout_lock(cout_mutex_);
+  std::cout << out.str() << std::flush;
 }
 
 }  // namespace lab7
-
@@ -0,0 +1,164 @@
+#include "game_config.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+namespace lab7 {
+namespace {
+
+constexpr std::string_view kUnlimited = "unlimited";
+constexpr std::string_view kOff = "off";
+constexpr std::string_view kWhitespace = " \t\r";
+
+std::string_view Trim(std::string_view text) {
+  const auto begin = text.find_first_not_of(kWhitespace);
+  if (begin == std::string_view::npos) return {};
+  const auto end = text.find_last_not_of(kWhitespace);
+  return text.substr(begin, end - begin + 1);
+}
+
+template <typename T>
+T ParseNumber(std::string_view key, std::string_view value, T min,
+              T max = std::numeric_limits<T>::max()) {
+  T result{};
+  const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+  if (error != std::errc() || end != value.data() + value.size() || result < min ||
+      result > max) {
+    throw std::invalid_argument("Invalid value for " + std::string(key) + ": " +
+                                std::string(value));
+  }
+  return result;
+}
+
+bool ParseBool(std::string_view key, std::string_view value) {
+  if (value == "true" || value == "1" || value == "yes") return true;
+  if (value == "false" || value == "0" || value == "no") return false;
+  throw std::invalid_argument("Invalid value for " + std::string(key) + ": " +
+                              std::string(value));
+}
+
+}  // namespace
+
+void GameConfig::Set(std::string_view key, std::string_view value) {
+  if (key == "map-size") {
+    map_size = ParseNumber(key, value, 1, MapBounds::kMaxSize);
+  } else if (key == "npcs") {
+    npc_count = ParseNumber(key, value, 0);
+  } else if (key == "ticks") {
+    tick_budget = value == kUnlimited ? 0 : ParseNumber<std::uint64_t>(key, value, 0);
+  } else if (key == "duration") {
+    duration = value == kUnlimited
+                   ? std::chrono::milliseconds::zero()
+                   : std::chrono::milliseconds(ParseNumber<std::int64_t>(key, value, 0) * 1000);
+  } else if (key == "tick-rate") {
+    tick_rate = value == kUnlimited ? kUnlimitedTickRate : ParseNumber(key, value, 0);
+  } else if (key == "render-interval") {
+    render_interval = std::chrono::milliseconds(ParseNumber<std::int64_t>(key, value, 1));
+  } else if (key == "combat-cooldown") {
+    combat_cooldown = value == kOff ? std::nullopt
+                                    : std::optional(ParseNumber<std::uint64_t>(key, value, 0));
+  } else if (key == "headless") {
+    headless = ParseBool(key, value);
+  } else if (key == "threads") {
+    thread_count = ParseNumber<std::size_t>(key, value, 1);
+  } else if (key == "combat-threads") {
+    combat_threads = ParseNumber<std::size_t>(key, value, 1);
+  } else if (key == "workers") {
+    worker_threads = ParseNumber<std::size_t>(key, value, 0);
+  } else if (key == "seed") {
+    seed = ParseNumber<std::uint64_t>(key, value, 0);
+  } else if (key == "metrics") {
+    metrics_file = std::string(value);
+  } else if (key == "metrics-format") {
+    if (value == "json") {
+      metrics_format = MetricsFormat::Json;
+    } else if (value == "prometheus") {
+      metrics_format = MetricsFormat::Prometheus;
+    } else {
+      throw std::invalid_argument("Invalid value for metrics-format: " + std::string(value));
+    }
+  } else if (key == "journal") {
+    journal_file = std::string(value);
+  } else {
+    throw std::invalid_argument("Unknown option: " + std::string(key));
+  }
+}
+
+void GameConfig::LoadFromStream(std::istream& is) {
+  std::string line;
+  while (std::getline(is, line)) {
+    std::string_view text = line;
+    text = Trim(text.substr(0, text.find('#')));
+    if (text.empty()) continue;
+
+    const auto separator = text.find('=');
+    if (separator == std::string_view::npos) {
+      throw std::invalid_argument("Expected key = value: " + line);
+    }
+    Set(Trim(text.substr(0, separator)), Trim(text.substr(separator + 1)));
+  }
+}
+
+void GameConfig::LoadFromFile(const std::string& filename) {
+  std::ifstream ifs(filename);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Cannot open file for reading: " + filename);
+  }
+  LoadFromStream(ifs);
+}
+
+void GameConfig::ParseArgs(int argc, char* argv[], int first) {
+  for (int i = first; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg.substr(0, 2) != "--") {
+      throw std::invalid_argument("Unexpected argument: " + std::string(arg));
+    }
+    arg.remove_prefix(2);
+
+    std::string_view key = arg;
+    std::string_view value;
+    if (const auto separator = arg.find('='); separator != std::string_view::npos) {
+      key = arg.substr(0, separator);
+      value = arg.substr(separator + 1);
+    } else if (key == "headless") {
+      value = "true";
+    } else if (i + 1 < argc) {
+      value = argv[++i];
+    } else {
+      throw std::invalid_argument("Missing value for " + std::string(key));
+    }
+
+    if (key == "config") {
+      LoadFromFile(std::string(value));
+    } else {
+      Set(key, value);
+    }
+  }
+}
+
+MapBounds GameConfig::GetBounds() const {
+  return MapBounds{map_size};
+}
+
+std::string_view GameConfig::GetHelp() {
+  return "  --map-size=N           side of the square map, up to 2^30 (default 100)\n"
+         "  --npcs=N               number of NPCs (default 50)\n"
+         "  --ticks=N|unlimited    stop after N ticks (default unlimited)\n"
+         "  --duration=S|unlimited wall-clock limit in seconds (default 30)\n"
+         "  --tick-rate=N|unlimited movement ticks per second (default 10)\n"
+         "  --render-interval=MS   map printing period (default 1000)\n"
+         "  --combat-cooldown=N|off ticks before a pair can fight again (default 0)\n"
+         "  --headless             no map, survivor or fight output\n"
+         "  --threads=N            movement/detection threads\n"
+         "  --combat-threads=N     fight resolution coroutines (default 2)\n"
+         "  --workers=N            scheduler threads, 0 for the calling thread (default 2)\n"
+         "  --seed=N               fixed seed instead of a random one\n"
+         "  --metrics=FILE         periodic metrics dump\n"
+         "  --metrics-format=json|prometheus\n"
+         "  --journal=FILE         binary journal of every fight (see lab7_journal)\n"
+         "  --config=FILE          read options from FILE (key = value lines)\n";
+}
+
+}  // namespace lab7
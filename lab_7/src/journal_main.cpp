@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "fight_journal.hpp"
+#include "npc_types.hpp"
+
+namespace {
+
+using lab7::CombatOutcome;
+using lab7::FightJournal;
+using lab7::FightRecord;
+using lab7::JournalFilter;
+using lab7::NpcType;
+
+constexpr std::array<NpcType, 3> kTypes = {NpcType::Bear, NpcType::Elf, NpcType::Robber};
+
+int Usage() {
+  std::cerr << "Usage:\n"
+            << "  lab7_journal info <file>\n"
+            << "  lab7_journal list <file> [filters] [--limit=N]\n"
+            << "  lab7_journal matrix <file> [filters]\n"
+            << "  lab7_journal replay <file> <tick> [--ids]\n"
+            << "Filters:\n"
+            << "  --type=bear|elf|robber either side of the fight\n"
+            << "  --from=TICK --to=TICK  inclusive tick range\n"
+            << "  --entity=ID            fights of one entity\n"
+            << "  --kills                only fights that ended in a kill\n"
+            << std::flush;
+  return 1;
+}
+
+NpcType ParseType(std::string_view value) {
+  if (value == "bear") return NpcType::Bear;
+  if (value == "elf") return NpcType::Elf;
+  if (value == "robber") return NpcType::Robber;
+  throw std::invalid_argument("Invalid type: " + std::string(value));
+}
+
+std::uint64_t ParseNumber(std::string_view key, std::string_view value) {
+  std::size_t used = 0;
+  std::uint64_t number = 0;
+  try {
+    number = std::stoull(std::string(value), &used);
+  } catch (const std::exception&) {
+    used = 0;
+  }
+  if (used == 0 || used != value.size()) {
+    throw std::invalid_argument("Invalid value for " + std::string(key) + ": " +
+                                std::string(value));
+  }
+  return number;
+}
+
+struct Options {
+  JournalFilter filter;
+  std::uint64_t limit = UINT64_MAX;
+  bool ids = false;
+};
+
+Options ParseOptions(int argc, char* argv[], int first) {
+  Options options;
+  for (int i = first; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    if (arg.substr(0, 2) != "--") {
+      throw std::invalid_argument("Unexpected argument: " + std::string(arg));
+    }
+    const std::size_t equals = arg.find('=');
+    const std::string_view key = arg.substr(2, equals == std::string_view::npos ? arg.npos
+                                                                                : equals - 2);
+    const std::string_view value =
+        equals == std::string_view::npos ? std::string_view() : arg.substr(equals + 1);
+    if (key == "type") {
+      options.filter.type = ParseType(value);
+    } else if (key == "from") {
+      options.filter.min_tick = ParseNumber(key, value);
+    } else if (key == "to") {
+      options.filter.max_tick = ParseNumber(key, value);
+    } else if (key == "entity") {
+      options.filter.entity = static_cast<lab7::EntityId>(ParseNumber(key, value));
+    } else if (key == "kills") {
+      options.filter.kills_only = true;
+    } else if (key == "limit") {
+      options.limit = ParseNumber(key, value);
+    } else if (key == "ids") {
+      options.ids = true;
+    } else {
+      throw std::invalid_argument("Unknown option: " + std::string(arg));
+    }
+  }
+  return options;
+}
+
+const char* GetOutcomeName(CombatOutcome outcome) {
+  switch (outcome) {
+    case CombatOutcome::Skipped:
+      return "skipped";
+    case CombatOutcome::NoWinner:
+      return "no winner";
+    case CombatOutcome::AttackerWon:
+      return "attacker won";
+    case CombatOutcome::DefenderWon:
+      return "defender won";
+  }
+  return "unknown";
+}
+
+void PrintRolls(std::ostream& os, std::uint8_t attack, std::uint8_t defense) {
+  if (attack == 0) {
+    os << "-";
+  } else {
+    os << static_cast<int>(attack) << ":" << static_cast<int>(defense);
+  }
+}
+
+void PrintRecord(std::ostream& os, const FightRecord& record) {
+  os << record.tick << " " << lab7::NpcStats::GetTypeName(record.attacker_type) << " #"
+     << record.attacker << " vs " << lab7::NpcStats::GetTypeName(record.defender_type) << " #"
+     << record.defender << " rolls ";
+  PrintRolls(os, record.rolls[0], record.rolls[1]);
+  os << " ";
+  PrintRolls(os, record.rolls[2], record.rolls[3]);
+  os << ": " << GetOutcomeName(record.outcome) << "\n";
+}
+
+int Info(const FightJournal& journal) {
+  std::uint64_t records = 0;
+  std::uint64_t last_tick = journal.GetStartTick();
+  for (const lab7::JournalIndexEntry& entry : journal.Blocks()) {
+    records += entry.block.record_count;
+    last_tick = std::max(last_tick, entry.block.last_tick);
+  }
+  std::cout << "Seed: " << journal.GetSeed() << "\n"
+            << "Start tick: " << journal.GetStartTick() << "\n"
+            << "Last tick: " << last_tick << "\n"
+            << "Entities: " << journal.Roster().size() << "\n"
+            << "Blocks: " << journal.Blocks().size()
+            << (journal.IsIndexed() ? "" : " (no index, scanned)") << "\n"
+            << "Fights: " << records << std::endl;
+  return 0;
+}
+
+int List(const FightJournal& journal, const Options& options) {
+  std::uint64_t printed = 0;
+  for (const lab7::JournalIndexEntry& entry : journal.Blocks()) {
+    if (!options.filter.MayMatch(entry.block)) continue;
+    for (const lab7::JournalRecord& encoded : journal.Records(entry)) {
+      const FightRecord record = FightJournal::Decode(encoded, entry.block.first_tick);
+      if (!options.filter.Matches(record)) continue;
+      if (printed++ == options.limit) {
+        std::cout << std::flush;
+        return 0;
+      }
+      PrintRecord(std::cout, record);
+    }
+  }
+  std::cout << std::flush;
+  return 0;
+}
+
+int Matrix(const FightJournal& journal, const Options& options) {
+  // kills[winner][loser]
+  std::array<std::array<std::uint64_t, lab7::NpcStats::kTypeCount>, lab7::NpcStats::kTypeCount>
+      kills{};
+  std::uint64_t fights = 0;
+  std::uint64_t no_winner = 0;
+  journal.ForEach(options.filter, [&](const FightRecord& record) {
+    ++fights;
+    switch (record.outcome) {
+      case CombatOutcome::Skipped:
+        break;
+      case CombatOutcome::NoWinner:
+        ++no_winner;
+        break;
+      case CombatOutcome::AttackerWon:
+        ++kills[static_cast<std::size_t>(record.attacker_type)]
+               [static_cast<std::size_t>(record.defender_type)];
+        break;
+      case CombatOutcome::DefenderWon:
+        ++kills[static_cast<std::size_t>(record.defender_type)]
+               [static_cast<std::size_t>(record.attacker_type)];
+        break;
+    }
+  });
+
+  std::cout << "Fights: " << fights << ", no winner: " << no_winner << "\n"
+            << "Kills (rows: winner, columns: loser)\n"
+            << std::setw(8) << "";
+  for (const NpcType loser : kTypes) {
+    std::cout << std::setw(10) << lab7::NpcStats::GetTypeName(loser);
+  }
+  std::cout << "\n";
+  for (const NpcType winner : kTypes) {
+    std::cout << std::setw(8) << lab7::NpcStats::GetTypeName(winner);
+    for (const NpcType loser : kTypes) {
+      std::cout << std::setw(10)
+                << kills[static_cast<std::size_t>(winner)][static_cast<std::size_t>(loser)];
+    }
+    std::cout << "\n";
+  }
+  std::cout << std::flush;
+  return 0;
+}
+
+int Replay(const FightJournal& journal, std::uint64_t tick, const Options& options) {
+  const auto alive = journal.ReplayAlive(tick);
+  const auto roster = journal.Roster();
+  std::array<std::uint64_t, lab7::NpcStats::kTypeCount> counts{};
+  std::uint64_t total = 0;
+  for (std::size_t id = 0; id < alive.size(); ++id) {
+    if (!alive[id]) continue;
+    ++counts[roster[id] & ~FightJournal::kAliveBit];
+    ++total;
+  }
+
+  std::cout << "Alive after tick " << tick << ": " << total;
+  for (const NpcType type : kTypes) {
+    std::cout << ", " << lab7::NpcStats::GetTypeName(type) << " "
+              << counts[static_cast<std::size_t>(type)];
+  }
+  std::cout << "\n";
+  if (options.ids) {
+    for (std::size_t id = 0; id < alive.size(); ++id) {
+      if (alive[id]) std::cout << id << "\n";
+    }
+  }
+  std::cout << std::flush;
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const std::string command = argc > 1 ? argv[1] : "";
+  if (argc < 3) {
+    return Usage();
+  }
+
+  try {
+    const FightJournal journal(argv[2]);
+    if (command == "info" && argc == 3) {
+      return Info(journal);
+    }
+    if (command == "list") {
+      return List(journal, ParseOptions(argc, argv, 3));
+    }
+    if (command == "matrix") {
+      return Matrix(journal, ParseOptions(argc, argv, 3));
+    }
+    if (command == "replay" && argc >= 4) {
+      return Replay(journal, ParseNumber("tick", argv[3]), ParseOptions(argc, argv, 4));
+    }
+  } catch (const std::invalid_argument& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return Usage();
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  return Usage();
+}
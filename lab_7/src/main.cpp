@@ -1,16 +1,170 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 #include "game.hpp"
 
-int main() {
-  lab7::Game game;
+namespace {
+
+int Usage() {
+  std::cerr << "Usage:\n"
+            << "  lab7_main [options]\n"
+            << "  lab7_main record <file> <seed> <ticks> [npc_count]\n"
+            << "  lab7_main replay <file>\n"
+            << "  lab7_main checkpoint <file> <seed> <ticks> <every> [npc_count]\n"
+            << "  lab7_main resume <file> <ticks> [every]\n"
+            << "Options:\n"
+            << lab7::GameConfig::GetHelp() << std::flush;
+  return 1;
+}
+
+void PrintLimits(const lab7::GameConfig& config) {
+  std::cout << "Starting game (";
+  if (config.duration.count() > 0) {
+    std::cout << config.duration.count() / 1000.0 << " seconds";
+  } else {
+    std::cout << "no time limit";
+  }
+  if (config.tick_budget > 0) {
+    std::cout << ", " << config.tick_budget << " ticks";
+  }
+  if (config.tick_rate == lab7::GameConfig::kUnlimitedTickRate) {
+    std::cout << ", unlimited tick rate";
+  }
+  std::cout << ")..." << std::endl;
+}
+
+int Play(const lab7::GameConfig& config) {
+  lab7::Game game(config);
   
-  std::cout << "Initializing game with 50 NPCs..." << std::endl;
-  game.Initialize(50);
+  std::cout << "Initializing game with " << config.npc_count << " NPCs..." << std::endl;
+  if (config.seed) {
+    game.Initialize(config.npc_count, *config.seed);
+  } else {
+    game.Initialize(config.npc_count);
+  }
+  std::cout << "Seed: " << game.GetSeed() << std::endl;
   
-  std::cout << "Starting game (30 seconds)..." << std::endl;
+  PrintLimits(config);
+  const auto start = std::chrono::steady_clock::now();
   game.Run();
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  
+  const auto stats = game.GetCombatQueueStats();
+  std::cout << "Combat queue: enqueued " << stats.enqueued << ", dequeued " << stats.dequeued
+            << ", dropped " << stats.dropped << ", high water " << stats.high_water << std::endl;
+  
+  const auto metrics = game.GetMetrics();
+  const auto& tick_ns = metrics.Get(lab7::Histogram::MovementTickNs);
+  std::cout << "Ticks: " << metrics.Get(lab7::Counter::Ticks) << ", kills "
+            << metrics.Get(lab7::Counter::Kills) << ", no winner "
+            << metrics.Get(lab7::Counter::NoWinner) << ", tick p50 " << tick_ns.Percentile(0.5)
+            << " ns, p99 " << tick_ns.Percentile(0.99) << " ns" << std::endl;
   
+  const double seconds = elapsed.count();
+  std::cout << "Throughput: " << metrics.Get(lab7::Counter::Ticks) / seconds << " ticks/s, "
+            << metrics.Get(lab7::Counter::EntityUpdates) / seconds << " entity updates/s over "
+            << seconds << " s" << std::endl;
+  return 0;
+}
+
+int Record(const std::string& filename, std::uint64_t seed, std::uint64_t ticks, int npc_count) {
+  lab7::Game game;
+  game.Initialize(npc_count, seed);
+  game.SaveRecording(filename, ticks);
+  game.Step(ticks);
+  game.PrintSurvivors();
+  return 0;
+}
+
+int Replay(const std::string& filename) {
+  lab7::Game game;
+  const std::uint64_t ticks = game.LoadRecording(filename);
+  game.Step(ticks);
+  game.PrintSurvivors();
   return 0;
 }
 
+// Steps `ticks` ticks, checkpointing to the file every `every` ticks.
+void StepWithCheckpoints(lab7::Game& game, const std::string& filename, std::uint64_t ticks,
+                         std::uint64_t every) {
+  if (every == 0) {
+    throw std::invalid_argument("Checkpoint interval must be positive");
+  }
+  for (std::uint64_t done = 0; done < ticks;) {
+    const std::uint64_t step = std::min(every, ticks - done);
+    game.Step(step);
+    done += step;
+    const auto info = game.Checkpoint(filename);
+    std::cout << "Checkpoint at tick " << game.GetTick() << ": " << (info.full ? "full" : "delta")
+              << ", " << info.entities << " entities, " << info.bytes << " bytes" << std::endl;
+  }
+}
+
+int RunCheckpointed(const std::string& filename, std::uint64_t seed, std::uint64_t ticks,
+                    std::uint64_t every, int npc_count) {
+  lab7::Game game;
+  game.Initialize(npc_count, seed);
+  StepWithCheckpoints(game, filename, ticks, every);
+  game.PrintSurvivors();
+  return 0;
+}
+
+int Resume(const std::string& filename, std::uint64_t ticks, std::uint64_t every) {
+  lab7::Game game;
+  game.Restore(filename);
+  std::cout << "Resumed at tick " << game.GetTick() << std::endl;
+  StepWithCheckpoints(game, filename, ticks, every);
+  game.PrintSurvivors();
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const std::string command = argc > 1 ? argv[1] : "";
+  
+  try {
+    if (command == "record" && (argc == 5 || argc == 6)) {
+      return Record(argv[2], std::stoull(argv[3]), std::stoull(argv[4]),
+                    argc == 6 ? std::stoi(argv[5]) : 50);
+    }
+    if (command == "replay" && argc == 3) {
+      return Replay(argv[2]);
+    }
+    if (command == "checkpoint" && (argc == 6 || argc == 7)) {
+      return RunCheckpointed(argv[2], std::stoull(argv[3]), std::stoull(argv[4]),
+                             std::stoull(argv[5]), argc == 7 ? std::stoi(argv[6]) : 50);
+    }
+    if (command == "resume" && (argc == 4 || argc == 5)) {
+      const std::uint64_t ticks = std::stoull(argv[3]);
+      const std::uint64_t every =
+          argc == 5 ? std::stoull(argv[4]) : std::max(ticks, std::uint64_t{1});
+      return Resume(argv[2], ticks, every);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  
+  if (command == "--help") {
+    return Usage();
+  }
+  
+  lab7::GameConfig config;
+  config.metrics_file = "metrics.json";
+  try {
+    config.ParseArgs(argc, argv);
+    return Play(config);
+  } catch (const std::invalid_argument& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return Usage();
+  } catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,82 @@
+#include "mapped_file.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <stdexcept>
+
+namespace lab7 {
+
+#ifndef _WIN32
+
+MappedFile::MappedFile(const std::string& filename) {
+  const int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open file for reading: " + filename);
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot read file: " + filename);
+  }
+  size_ = static_cast<std::size_t>(info.st_size);
+  if (size_ == 0) {
+    close(fd);
+    return;
+  }
+  void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("Cannot map file: " + filename);
+  }
+  data_ = static_cast<const char*>(data);
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+void MappedFile::AdviseSequential() const {
+  if (data_) {
+    madvise(const_cast<char*>(data_), size_, MADV_SEQUENTIAL);
+  }
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) {
+  std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
+  if (!ifs.is_open()) {
+    throw std::runtime_error("Cannot open file for reading: " + filename);
+  }
+  size_ = static_cast<std::size_t>(ifs.tellg());
+  buffer_ = std::make_unique<std::max_align_t[]>(size_ / sizeof(std::max_align_t) + 1);
+  ifs.seekg(0);
+  if (!ifs.read(reinterpret_cast<char*>(buffer_.get()), static_cast<std::streamsize>(size_))) {
+    throw std::runtime_error("Cannot read file: " + filename);
+  }
+  data_ = reinterpret_cast<const char*>(buffer_.get());
+}
+
+MappedFile::~MappedFile() = default;
+
+void MappedFile::AdviseSequential() const {}
+
+#endif  // _WIN32
+
+const char* MappedFile::Data() const {
+  return data_;
+}
+
+std::size_t MappedFile::Size() const {
+  return size_;
+}
+
+}  // namespace lab7
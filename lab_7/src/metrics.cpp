@@ -0,0 +1,255 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+#include "thread_local_cache.hpp"
+
+namespace lab7 {
+namespace {
+
+constexpr std::string_view kPrometheusPrefix = "lab7_";
+constexpr std::array<double, 4> kQuantiles = {0.5, 0.9, 0.99, 0.999};
+
+constexpr std::array<std::string_view, static_cast<std::size_t>(Counter::kCount)> kCounterNames = {
+    "ticks",
+    "entity_updates",
+    "combat_tasks",
+    "encounters_on_cooldown",
+    "tasks_dropped",
+    "kills",
+    "no_winner",
+    "combat_skipped",
+    "entities_compacted",
+    "frames",
+    "frames_skipped",
+};
+
+constexpr std::array<std::string_view, static_cast<std::size_t>(Histogram::kCount)>
+    kHistogramNames = {"movement_tick_ns", "combat_batch_ns", "render_ns", "queue_depth"};
+
+std::atomic<std::uint64_t> next_registry_id{0};
+
+template <typename T>
+void AddRelaxed(std::atomic<T>& value, T delta) {
+  value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+void WriteJson(const MetricsSnapshot& snapshot, std::ostream& os) {
+  os << "{\n  \"counters\": {";
+  for (std::size_t i = 0; i < kCounterNames.size(); ++i) {
+    os << (i ? ", " : "") << '"' << kCounterNames[i] << "\": " << snapshot.counters[i];
+  }
+  const QueueStats& queue = snapshot.combat_queue;
+  os << "},\n  \"combat_queue\": {\"enqueued\": " << queue.enqueued
+     << ", \"dequeued\": " << queue.dequeued << ", \"dropped\": " << queue.dropped
+     << ", \"high_water\": " << queue.high_water << "},\n  \"histograms\": {";
+  for (std::size_t i = 0; i < kHistogramNames.size(); ++i) {
+    const HistogramSnapshot& histogram = snapshot.histograms[i];
+    os << (i ? "," : "") << "\n    \"" << kHistogramNames[i] << "\": {\"count\": "
+       << histogram.count << ", \"sum\": " << histogram.sum << ", \"min\": " << histogram.min
+       << ", \"max\": " << histogram.max;
+    for (double q : kQuantiles) {
+      os << ", \"p" << q * 100 << "\": " << histogram.Percentile(q);
+    }
+    os << '}';
+  }
+  os << "\n  }\n}\n";
+}
+
+void WritePrometheus(const MetricsSnapshot& snapshot, std::ostream& os) {
+  for (std::size_t i = 0; i < kCounterNames.size(); ++i) {
+    os << "# TYPE " << kPrometheusPrefix << kCounterNames[i] << "_total counter\n"
+       << kPrometheusPrefix << kCounterNames[i] << "_total " << snapshot.counters[i] << '\n';
+  }
+  const QueueStats& queue = snapshot.combat_queue;
+  os << "# TYPE " << kPrometheusPrefix << "combat_queue_high_water gauge\n"
+     << kPrometheusPrefix << "combat_queue_high_water " << queue.high_water << '\n'
+     << "# TYPE " << kPrometheusPrefix << "combat_queue_dropped_total counter\n"
+     << kPrometheusPrefix << "combat_queue_dropped_total " << queue.dropped << '\n';
+  for (std::size_t i = 0; i < kHistogramNames.size(); ++i) {
+    const HistogramSnapshot& histogram = snapshot.histograms[i];
+    const std::string name = std::string(kPrometheusPrefix).append(kHistogramNames[i]);
+    os << "# TYPE " << name << " summary\n";
+    for (double q : kQuantiles) {
+      os << name << "{quantile=\"" << q << "\"} " << histogram.Percentile(q) << '\n';
+    }
+    os << name << "_sum " << histogram.sum << '\n' << name << "_count " << histogram.count << '\n';
+  }
+}
+
+}  // namespace
+
+std::string_view GetCounterName(Counter counter) {
+  return kCounterNames[static_cast<std::size_t>(counter)];
+}
+
+std::string_view GetHistogramName(Histogram histogram) {
+  return kHistogramNames[static_cast<std::size_t>(histogram)];
+}
+
+std::size_t HistogramBuckets::IndexOf(std::uint64_t value) {
+  value = std::min(value, kMaxValue);
+  if (value < kSubBuckets) {
+    return static_cast<std::size_t>(value);
+  }
+  const int shift = std::bit_width(value) - 1 - kSubBucketBits;
+  return static_cast<std::size_t>((shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets));
+}
+
+std::uint64_t HistogramBuckets::UpperBound(std::size_t index) {
+  if (index < kSubBuckets) {
+    return index;
+  }
+  const auto shift = static_cast<int>(index / kSubBuckets) - 1;
+  const std::uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+  return lower + (std::uint64_t{1} << shift) - 1;
+}
+
+std::uint64_t HistogramSnapshot::Percentile(double q) const {
+  if (count == 0) {
+    return 0;
+  }
+  const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(q * count + 0.5));
+  std::uint64_t seen = 0;
+  for (std::size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return std::clamp(HistogramBuckets::UpperBound(i), min, max);
+    }
+  }
+  return max;
+}
+
+std::uint64_t MetricsSnapshot::Get(Counter counter) const {
+  return counters[static_cast<std::size_t>(counter)];
+}
+
+const HistogramSnapshot& MetricsSnapshot::Get(Histogram histogram) const {
+  return histograms[static_cast<std::size_t>(histogram)];
+}
+
+void WriteMetrics(const MetricsSnapshot& snapshot, MetricsFormat format, std::ostream& os) {
+  switch (format) {
+    case MetricsFormat::Json:
+      WriteJson(snapshot, os);
+      return;
+    case MetricsFormat::Prometheus:
+      WritePrometheus(snapshot, os);
+      return;
+  }
+}
+
+void WriteMetricsFile(const MetricsSnapshot& snapshot, MetricsFormat format,
+                      const std::string& filename) {
+  const std::string temp = filename + ".tmp";
+  {
+    std::ofstream ofs(temp);
+    if (!ofs.is_open()) {
+      throw std::runtime_error("Cannot open file for writing: " + temp);
+    }
+    WriteMetrics(snapshot, format, ofs);
+  }
+  if (std::rename(temp.c_str(), filename.c_str()) != 0) {
+    throw std::runtime_error("Cannot write metrics file: " + filename);
+  }
+}
+
+void MetricsShard::Add(Counter counter, std::uint64_t value) {
+  AddRelaxed(counters_[static_cast<std::size_t>(counter)], value);
+}
+
+void MetricsShard::Record(Histogram histogram, std::uint64_t value) {
+  HistogramData& data = histograms_[static_cast<std::size_t>(histogram)];
+  AddRelaxed(data.buckets[HistogramBuckets::IndexOf(value)], std::uint64_t{1});
+  AddRelaxed(data.count, std::uint64_t{1});
+  AddRelaxed(data.sum, value);
+  if (value < data.min.load(std::memory_order_relaxed)) {
+    data.min.store(value, std::memory_order_relaxed);
+  }
+  if (value > data.max.load(std::memory_order_relaxed)) {
+    data.max.store(value, std::memory_order_relaxed);
+  }
+}
+
+void MetricsShard::Record(Histogram histogram, std::chrono::steady_clock::duration duration) {
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  Record(histogram, static_cast<std::uint64_t>(std::max<std::int64_t>(ns, 0)));
+}
+
+MetricsRegistry::MetricsRegistry() : id_(next_registry_id++) {}
+
+MetricsShard& MetricsRegistry::Local() {
+  return ThreadLocalFor<MetricsShard>(id_, [this]() -> MetricsShard& {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_.push_back(std::make_unique<MetricsShard>());
+    return *shards_.back();
+  });
+}
+
+MetricsSnapshot MetricsRegistry::Snapshot() const {
+  MetricsSnapshot snapshot;
+  for (auto& histogram : snapshot.histograms) {
+    histogram.buckets.assign(HistogramBuckets::kCount, 0);
+    histogram.min = UINT64_MAX;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& shard : shards_) {
+    for (std::size_t i = 0; i < snapshot.counters.size(); ++i) {
+      snapshot.counters[i] += shard->counters_[i].load(std::memory_order_relaxed);
+    }
+    for (std::size_t h = 0; h < snapshot.histograms.size(); ++h) {
+      const auto& data = shard->histograms_[h];
+      HistogramSnapshot& histogram = snapshot.histograms[h];
+      for (std::size_t i = 0; i < HistogramBuckets::kCount; ++i) {
+        histogram.buckets[i] += data.buckets[i].load(std::memory_order_relaxed);
+      }
+      histogram.count += data.count.load(std::memory_order_relaxed);
+      histogram.sum += data.sum.load(std::memory_order_relaxed);
+      histogram.min = std::min(histogram.min, data.min.load(std::memory_order_relaxed));
+      histogram.max = std::max(histogram.max, data.max.load(std::memory_order_relaxed));
+    }
+  }
+
+  for (auto& histogram : snapshot.histograms) {
+    if (histogram.count == 0) histogram.min = 0;
+  }
+  return snapshot;
+}
+
+std::size_t MetricsRegistry::GetShardCount() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return shards_.size();
+}
+
+void MetricsRegistry::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& shard : shards_) {
+    for (auto& counter : shard->counters_) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto& data : shard->histograms_) {
+      for (auto& bucket : data.buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+      data.count.store(0, std::memory_order_relaxed);
+      data.sum.store(0, std::memory_order_relaxed);
+      data.min.store(UINT64_MAX, std::memory_order_relaxed);
+      data.max.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+ScopedTimer::ScopedTimer(MetricsShard& shard, Histogram histogram)
+    : shard_(shard), histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+ScopedTimer::~ScopedTimer() {
+  shard_.Record(histogram_, std::chrono::steady_clock::now() - start_);
+}
+
+}  // namespace lab7
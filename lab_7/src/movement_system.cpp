@@ -0,0 +1,199 @@
+#include "movement_system.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "npc_types.hpp"
+#include "rng.hpp"
+#include "thread_pool.hpp"
+
+namespace lab7 {
+namespace {
+
+constexpr int kGridCellSize = std::min({NpcStats::GetKillDistance(NpcType::Bear),
+                                        NpcStats::GetKillDistance(NpcType::Elf),
+                                        NpcStats::GetKillDistance(NpcType::Robber)});
+// Sparse cells span at least the longest kill distance, so a query looks up
+// at most 3x3 cells.
+constexpr int kSparseCellSize = std::max({NpcStats::GetKillDistance(NpcType::Bear),
+                                          NpcStats::GetKillDistance(NpcType::Elf),
+                                          NpcStats::GetKillDistance(NpcType::Robber)});
+// 16 MB of cell offsets; larger maps (about 20000 wide) use a SparseGrid.
+constexpr std::int64_t kMaxDenseCells = std::int64_t{1} << 22;
+constexpr double kTwoPi = 2.0 * 3.14159265359;
+constexpr std::size_t kMoveChunk = 4096;
+constexpr std::size_t kDetectChunk = 1024;
+// A movement block holds one direction byte for each of 16 consecutive ids.
+constexpr std::uint32_t kIdsPerBlock = 16;
+constexpr std::size_t kDirectionCount = 256;
+constexpr std::size_t kTypeCount = 4;
+
+// Step of each type in each of kDirectionCount evenly spaced directions,
+// truncated toward zero; row 0 (Unknown) does not move.
+struct StepTable {
+  std::array<std::array<int, kDirectionCount>, kTypeCount> dx;
+  std::array<std::array<int, kDirectionCount>, kTypeCount> dy;
+};
+
+const StepTable& GetStepTable() {
+  static const StepTable table = [] {
+    StepTable steps{};
+    for (std::size_t type = 0; type < kTypeCount; ++type) {
+      const int move_dist = NpcStats::GetMoveDistance(static_cast<NpcType>(type));
+      for (std::size_t direction = 0; direction < kDirectionCount; ++direction) {
+        const double angle = kTwoPi * static_cast<double>(direction) / kDirectionCount;
+        steps.dx[type][direction] = static_cast<int>(move_dist * std::cos(angle));
+        steps.dy[type][direction] = static_cast<int>(move_dist * std::sin(angle));
+      }
+    }
+    return steps;
+  }();
+  return table;
+}
+
+std::uint32_t GetDirection(const RandomBlock& block, std::uint32_t lane) {
+  return (block[lane / 4] >> (8 * (lane % 4))) & 0xFF;
+}
+
+// Branchless so the loop vectorizes.
+void ClampPositions(int* xs, int* ys, std::size_t count, int map_size) {
+  for (std::size_t i = 0; i < count; ++i) {
+    xs[i] = std::min(std::max(xs[i], 0), map_size);
+    ys[i] = std::min(std::max(ys[i], 0), map_size);
+  }
+}
+
+std::variant<SpatialGrid, SparseGrid> MakeGrid(int map_size) {
+  const std::int64_t cells_per_side = map_size / kGridCellSize + 1;
+  if (cells_per_side * cells_per_side > kMaxDenseCells) {
+    return std::variant<SpatialGrid, SparseGrid>(std::in_place_type<SparseGrid>,
+                                                 kSparseCellSize);
+  }
+  return std::variant<SpatialGrid, SparseGrid>(std::in_place_type<SpatialGrid>, map_size,
+                                               kGridCellSize);
+}
+
+}  // namespace
+
+MovementSystem::MovementSystem(int map_size) : map_size_(map_size), grid_(MakeGrid(map_size)) {}
+
+void MovementSystem::SetUniquePairs(bool unique_pairs) {
+  unique_pairs_ = unique_pairs;
+}
+
+void MovementSystem::Move(World& world, std::uint64_t tick, ThreadPool& pool) {
+  const auto types = world.Types();
+  const auto live = world.LiveIds();
+  const std::uint64_t seed = world.GetSeed();
+  const StepTable& steps = GetStepTable();
+  move_groups_.resize(live.size());
+  move_blocks_.resize(live.size());
+  move_xs_.resize(live.size());
+  move_ys_.resize(live.size());
+
+  pool.ParallelFor(live.size(), kMoveChunk, [&](std::size_t, std::size_t begin, std::size_t end) {
+    // One block per group of ids met in the chunk; live ids mostly ascend,
+    // so neighbours share it.
+    std::size_t groups = 0;
+    std::uint32_t last_group = UINT32_MAX;
+    for (std::size_t i = begin; i < end; ++i) {
+      const std::uint32_t group = live[i] / kIdsPerBlock;
+      if (group != last_group) move_groups_[begin + groups++] = group;
+      last_group = group;
+    }
+    FillRandomBlocks(seed, RngStream::Movement,
+                     std::span<const std::uint32_t>(move_groups_.data() + begin, groups), tick,
+                     std::span<RandomBlock>(move_blocks_.data() + begin, groups));
+
+    // Gather: dead entities take the zero row of the table and stay put.
+    std::size_t block = begin;
+    last_group = live[begin] / kIdsPerBlock;
+    for (std::size_t i = begin; i < end; ++i) {
+      const EntityId id = live[i];
+      const std::uint32_t group = id / kIdsPerBlock;
+      block += group != last_group;
+      last_group = group;
+      const std::uint32_t direction = GetDirection(move_blocks_[block], id % kIdsPerBlock);
+      const std::size_t row = world.IsAlive(id) ? static_cast<std::size_t>(types[id]) : 0;
+      move_xs_[i] = world.GetX(id) + steps.dx[row][direction];
+      move_ys_[i] = world.GetY(id) + steps.dy[row][direction];
+    }
+
+    ClampPositions(move_xs_.data() + begin, move_ys_.data() + begin, end - begin, map_size_);
+
+    for (std::size_t i = begin; i < end; ++i) {
+      world.SetPosition(live[i], move_xs_[i], move_ys_[i]);
+    }
+  });
+}
+
+template <typename Grid>
+void MovementSystem::DetectRange(const Grid& grid, std::span<const NpcType> types,
+                                 std::uint64_t tick, std::size_t begin, std::size_t end,
+                                 std::vector<CombatTask>& out) const {
+  out.clear();
+  for (std::size_t i = begin; i < end; ++i) {
+    const int kill_dist = NpcStats::GetKillDistance(types[alive_ids_[i]]);
+    grid.ForEachInRadius(xs_[i], ys_[i], kill_dist, [&](std::size_t j) {
+      if (j == i) return;
+      // Entries are in live order, so j < i means j's own query already
+      // found i if i is within j's kill distance.
+      if (unique_pairs_ && j < i) {
+        const std::int64_t dx = static_cast<std::int64_t>(xs_[j]) - xs_[i];
+        const std::int64_t dy = static_cast<std::int64_t>(ys_[j]) - ys_[i];
+        const std::int64_t reach = NpcStats::GetKillDistance(types[alive_ids_[j]]);
+        if (dx * dx + dy * dy <= reach * reach) return;
+      }
+      out.push_back(CombatTask{alive_ids_[i], alive_ids_[j], tick});
+    });
+  }
+  // Grid order depends only on positions; sorting makes the resolution
+  // order independent of how candidates were collected.
+  std::sort(out.begin(), out.end(), [](const CombatTask& a, const CombatTask& b) {
+    return a.attacker != b.attacker ? a.attacker < b.attacker : a.defender < b.defender;
+  });
+}
+
+const std::vector<CombatTask>& MovementSystem::Detect(const World& world, std::uint64_t tick,
+                                                      ThreadPool& pool) {
+  alive_ids_.clear();
+  xs_.clear();
+  ys_.clear();
+  for (const EntityId id : world.LiveIds()) {
+    if (!world.IsAlive(id)) continue;
+    alive_ids_.push_back(id);
+    xs_.push_back(world.GetX(id));
+    ys_.push_back(world.GetY(id));
+  }
+
+  const auto types = world.Types();
+  chunk_encounters_.resize(pool.GetChunkCount(alive_ids_.size(), kDetectChunk));
+  std::visit([&](auto& grid) {
+    grid.Build(xs_, ys_);
+    pool.ParallelFor(alive_ids_.size(), kDetectChunk,
+                     [&](std::size_t chunk, std::size_t begin, std::size_t end) {
+      DetectRange(grid, types, tick, begin, end, chunk_encounters_[chunk]);
+    });
+  }, grid_);
+
+  encounters_.clear();
+  for (const auto& chunk : chunk_encounters_) {
+    encounters_.insert(encounters_.end(), chunk.begin(), chunk.end());
+  }
+  return encounters_;
+}
+
+std::size_t MovementSystem::GetAliveCount() const {
+  return alive_ids_.size();
+}
+
+bool MovementSystem::IsSparse() const {
+  return std::holds_alternative<SparseGrid>(grid_);
+}
+
+std::size_t MovementSystem::GetGridMemoryUsage() const {
+  return std::visit([](const auto& grid) { return grid.GetMemoryUsage(); }, grid_);
+}
+
+}  // namespace lab7
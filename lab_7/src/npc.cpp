@@ -1,85 +1,118 @@
 #include "npc.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
 #include <random>
 
 #include "npc_types.hpp"
-#include "observer.hpp"
+#include "rng.hpp"
+#include "world.hpp"
 
 namespace lab7 {
 namespace {
 
-int RollD6() {
-  thread_local std::random_device rd;
-  thread_local std::mt19937 gen(rd());
-  thread_local std::uniform_int_distribution<> dice(1, 6);
-  return dice(gen);
+// Unbound NPCs roll from a dice stream keyed by a per-process seed and a
+// serial number, so they need neither a world nor per-thread engines.
+std::uint64_t GetStandaloneSeed() {
+  static const std::uint64_t seed = [] {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) | rd();
+  }();
+  return seed;
 }
 
-}  // namespace
+std::uint32_t NextSerial() {
+  static std::atomic<std::uint32_t> next_serial{0};
+  return next_serial.fetch_add(1, std::memory_order_relaxed);
+}
 
-NPC::NPC(NpcType type, const std::string& name, int x, int y)
-    : name_(name), x_(x), y_(y), type_(type), alive_(true) {
-  if (x_ < 0) x_ = 0;
-  if (x_ > 100) x_ = 100;
-  if (y_ < 0) y_ = 0;
-  if (y_ > 100) y_ = 100;
+// Coordinates lie in [0, MapBounds::kMaxSize], so the sum of squared
+// differences fits 61 bits; capping the distance keeps its square in 64.
+bool IsWithin(std::int64_t dx, std::int64_t dy, std::size_t distance) {
+  const auto reach = static_cast<std::uint64_t>(std::min<std::size_t>(distance, UINT32_MAX));
+  return static_cast<std::uint64_t>(dx * dx + dy * dy) <= reach * reach;
 }
 
-void NPC::Subscribe(std::shared_ptr<IFightObserver> observer) {
+}  // namespace
+
+NPC::NPC(NpcType type, const std::string& name, int x, int y, MapBounds bounds)
+    : name_(name),
+      x_(bounds.Clamp(x)),
+      y_(bounds.Clamp(y)),
+      bounds_(bounds),
+      type_(type),
+      alive_(true),
+      world_(nullptr),
+      id_(0),
+      generation_(0),
+      serial_(NextSerial()),
+      roll_count_(0) {}
+
+void NPC::Bind(World& world, EntityId id) {
   std::unique_lock<std::shared_mutex> lock(mutex_);
-  observers_.push_back(observer);
+  world_ = &world;
+  id_ = id;
+  generation_ = world.GetHandle(id).generation;
 }
 
-void NPC::FightNotify(const std::shared_ptr<NPC>& attacker,
-                      const std::shared_ptr<NPC>& defender,
-                      bool win) {
-  std::vector<std::shared_ptr<IFightObserver>> observers_copy;
-  {
-    std::shared_lock<std::shared_mutex> lock(mutex_);
-    observers_copy = observers_;
-  }
+bool NPC::IsCurrent() const {
+  return world_->IsCurrent(EntityHandle{id_, generation_});
+}
 
-  for (const auto& observer : observers_copy) {
-    observer->OnFight(attacker, defender, win);
-  }
+EntityId NPC::GetId() const {
+  return id_;
 }
 
 bool NPC::IsClose(const std::shared_ptr<NPC>& other, size_t distance) const {
+  if (world_ || other->world_) {
+    const std::int64_t dx = static_cast<std::int64_t>(GetX()) - other->GetX();
+    const std::int64_t dy = static_cast<std::int64_t>(GetY()) - other->GetY();
+    return IsWithin(dx, dy, distance);
+  }
+
   if (this < other.get()) {
     std::shared_lock<std::shared_mutex> lock(mutex_);
     std::shared_lock<std::shared_mutex> other_lock(other->mutex_);
     
-    auto dx = x_ - other->x_;
-    auto dy = y_ - other->y_;
-    return (dx * dx + dy * dy) <= static_cast<int>(distance * distance);
+    return IsWithin(static_cast<std::int64_t>(x_) - other->x_,
+                    static_cast<std::int64_t>(y_) - other->y_, distance);
   } else {
     std::shared_lock<std::shared_mutex> other_lock(other->mutex_);
     std::shared_lock<std::shared_mutex> lock(mutex_);
     
-    auto dx = x_ - other->x_;
-    auto dy = y_ - other->y_;
-    return (dx * dx + dy * dy) <= static_cast<int>(distance * distance);
+    return IsWithin(static_cast<std::int64_t>(x_) - other->x_,
+                    static_cast<std::int64_t>(y_) - other->y_, distance);
   }
 }
 
 bool NPC::IsAlive() const {
+  if (world_) return IsCurrent() && world_->IsAlive(id_);
   std::shared_lock<std::shared_mutex> lock(mutex_);
   return alive_;
 }
 
 void NPC::Kill() {
+  if (world_) {
+    if (IsCurrent()) world_->Kill(id_);
+    return;
+  }
   std::unique_lock<std::shared_mutex> lock(mutex_);
   alive_ = false;
 }
 
 void NPC::Move(int new_x, int new_y) {
+  const MapBounds& bounds = world_ ? world_->GetBounds() : bounds_;
+  new_x = bounds.Clamp(new_x);
+  new_y = bounds.Clamp(new_y);
+
+  if (world_) {
+    if (IsCurrent() && world_->IsAlive(id_)) world_->SetPosition(id_, new_x, new_y);
+    return;
+  }
+
   std::unique_lock<std::shared_mutex> lock(mutex_);
   if (!alive_) return;
-
-  if (new_x < 0) new_x = 0;
-  if (new_x > 100) new_x = 100;
-  if (new_y < 0) new_y = 0;
-  if (new_y > 100) new_y = 100;
   
   x_ = new_x;
   y_ = new_y;
@@ -94,16 +127,19 @@ int NPC::GetKillDistance() const {
 }
 
 std::string NPC::GetName() const {
+  if (world_ && IsCurrent()) return world_->GetName(id_);
   std::shared_lock<std::shared_mutex> lock(mutex_);
   return name_;
 }
 
 int NPC::GetX() const {
+  if (world_ && IsCurrent()) return world_->GetX(id_);
   std::shared_lock<std::shared_mutex> lock(mutex_);
   return x_;
 }
 
 int NPC::GetY() const {
+  if (world_ && IsCurrent()) return world_->GetY(id_);
   std::shared_lock<std::shared_mutex> lock(mutex_);
   return y_;
 }
@@ -113,21 +149,21 @@ NpcType NPC::GetType() const {
 }
 
 int NPC::RollDice() const {
-  return RollD6();
+  if (world_ && IsCurrent()) return world_->RollDice(id_);
+  const std::uint32_t roll = roll_count_.fetch_add(1, std::memory_order_relaxed);
+  return CounterRng(GetStandaloneSeed(), RngStream::Dice, serial_, roll).NextInt(1, 6);
 }
 
 void NPC::Print(std::ostream& os) const {
-  std::shared_lock<std::shared_mutex> lock(mutex_);
-  os << NpcStats::GetTypeName(type_) << " \"" << name_ << "\" at (" 
-     << x_ << ", " << y_ << ")";
-  if (!alive_) {
+  os << NpcStats::GetTypeName(type_) << " \"" << GetName() << "\" at (" 
+     << GetX() << ", " << GetY() << ")";
+  if (!IsAlive()) {
     os << " [DEAD]";
   }
 }
 
 void NPC::Save(std::ostream& os) const {
-  std::shared_lock<std::shared_mutex> lock(mutex_);
-  os << static_cast<int>(type_) << " " << name_ << " " << x_ << " " << y_;
+  os << static_cast<int>(type_) << " " << GetName() << " " << GetX() << " " << GetY();
 }
 
 std::ostream& operator<<(std::ostream& os, const NPC& npc) {
@@ -2,45 +2,132 @@
 
 #include <fstream>
 #include <stdexcept>
+#include <string_view>
 
 #include "bear.hpp"
 #include "elf.hpp"
 #include "robber.hpp"
+#include "world_snapshot.hpp"
 
 namespace lab7 {
+namespace {
+
+void CheckCoordinates(int x, int y, const MapBounds& bounds) {
+  if (!bounds.Contains(x, y)) {
+    throw std::invalid_argument("Coordinates must be in range [0, " +
+                                std::to_string(bounds.size) + "]");
+  }
+}
+
+template <typename Create>
+std::shared_ptr<NPC> ReadNPC(std::istream& is, Create&& create) {
+  int type_int;
+  std::string name;
+  int x, y;
+
+  if (!(is >> type_int >> name >> x >> y)) {
+    return nullptr;
+  }
+
+  auto type = static_cast<NpcType>(type_int);
+  return create(type, name, x, y);
+}
+
+template <typename Create>
+std::vector<std::shared_ptr<NPC>> ReadNPCs(std::istream& is, Create&& create) {
+  std::vector<std::shared_ptr<NPC>> result;
+  size_t count;
+
+  if (!(is >> count)) {
+    return result;
+  }
+
+  result.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    auto npc = ReadNPC(is, create);
+    if (npc) {
+      result.push_back(npc);
+    }
+  }
+
+  return result;
+}
+
+template <typename Create>
+std::vector<std::shared_ptr<NPC>> ReadSnapshot(const std::string& filename, Create&& create) {
+  const WorldSnapshot snapshot(filename);
+  std::vector<std::shared_ptr<NPC>> result;
+  result.reserve(snapshot.Size());
+
+  const auto records = snapshot.Records();
+  for (std::size_t i = 0; i < records.size(); ++i) {
+    const auto& record = records[i];
+    const std::string_view name = snapshot.GetName(record);
+    auto npc = create(record.type, name.empty() ? "NPC" + std::to_string(i) : std::string(name),
+                      record.x, record.y);
+    if (!record.alive) {
+      npc->Kill();
+    }
+    result.push_back(std::move(npc));
+  }
+
+  return result;
+}
+
+}  // namespace
 
 std::shared_ptr<NPC> NpcFactory::CreateNPC(NpcType type,
                                            const std::string& name,
                                            int x,
-                                           int y) {
-  if (x < 0 || x > 100 || y < 0 || y > 100) {
-    throw std::invalid_argument("Coordinates must be in range [0, 100]");
-  }
+                                           int y,
+                                           const MapBounds& bounds) {
+  CheckCoordinates(x, y, bounds);
 
   switch (type) {
     case NpcType::Bear:
-      return std::make_shared<Bear>(name, x, y);
+      return std::make_shared<Bear>(name, x, y, bounds);
     case NpcType::Elf:
-      return std::make_shared<Elf>(name, x, y);
+      return std::make_shared<Elf>(name, x, y, bounds);
     case NpcType::Robber:
-      return std::make_shared<Robber>(name, x, y);
+      return std::make_shared<Robber>(name, x, y, bounds);
     case NpcType::Unknown:
       break;
   }
   throw std::invalid_argument("Unknown NPC type");
 }
 
-std::shared_ptr<NPC> NpcFactory::CreateNPC(std::istream& is) {
-  int type_int;
-  std::string name;
-  int x, y;
+std::shared_ptr<NPC> NpcFactory::CreateNPC(NpcType type,
+                                           const std::string& name,
+                                           int x,
+                                           int y,
+                                           NpcPool& pool,
+                                           const MapBounds& bounds) {
+  CheckCoordinates(x, y, bounds);
 
-  if (!(is >> type_int >> name >> x >> y)) {
-    return nullptr;
+  switch (type) {
+    case NpcType::Bear:
+      return std::allocate_shared<Bear>(pool.GetAllocator<Bear>(type), name, x, y, bounds);
+    case NpcType::Elf:
+      return std::allocate_shared<Elf>(pool.GetAllocator<Elf>(type), name, x, y, bounds);
+    case NpcType::Robber:
+      return std::allocate_shared<Robber>(pool.GetAllocator<Robber>(type), name, x, y, bounds);
+    case NpcType::Unknown:
+      break;
   }
+  throw std::invalid_argument("Unknown NPC type");
+}
 
-  auto type = static_cast<NpcType>(type_int);
-  return CreateNPC(type, name, x, y);
+std::shared_ptr<NPC> NpcFactory::CreateNPC(std::istream& is, const MapBounds& bounds) {
+  return ReadNPC(is, [&bounds](NpcType type, const std::string& name, int x, int y) {
+    return CreateNPC(type, name, x, y, bounds);
+  });
+}
+
+std::shared_ptr<NPC> NpcFactory::CreateNPC(std::istream& is, NpcPool& pool,
+                                           const MapBounds& bounds) {
+  return ReadNPC(is, [&](NpcType type, const std::string& name, int x, int y) {
+    return CreateNPC(type, name, x, y, pool, bounds);
+  });
 }
 
 void NpcFactory::SaveToFile(const std::vector<std::shared_ptr<NPC>>& npcs,
@@ -58,27 +145,47 @@ void NpcFactory::SaveToFile(const std::vector<std::shared_ptr<NPC>>& npcs,
 }
 
 std::vector<std::shared_ptr<NPC>> NpcFactory::LoadFromFile(
-    const std::string& filename) {
+    const std::string& filename, const MapBounds& bounds) {
   std::ifstream ifs(filename);
   if (!ifs.is_open()) {
     throw std::runtime_error("Cannot open file for reading: " + filename);
   }
 
-  std::vector<std::shared_ptr<NPC>> result;
-  size_t count;
+  return LoadFromStream(ifs, bounds);
+}
 
-  if (!(ifs >> count)) {
-    return result;
-  }
+std::vector<std::shared_ptr<NPC>> NpcFactory::LoadFromStream(std::istream& is,
+                                                             const MapBounds& bounds) {
+  return ReadNPCs(is, [&bounds](NpcType type, const std::string& name, int x, int y) {
+    return CreateNPC(type, name, x, y, bounds);
+  });
+}
 
-  for (size_t i = 0; i < count; ++i) {
-    auto npc = CreateNPC(ifs);
-    if (npc) {
-      result.push_back(npc);
-    }
-  }
+std::vector<std::shared_ptr<NPC>> NpcFactory::LoadFromStream(std::istream& is, NpcPool& pool,
+                                                             const MapBounds& bounds) {
+  return ReadNPCs(is, [&](NpcType type, const std::string& name, int x, int y) {
+    return CreateNPC(type, name, x, y, pool, bounds);
+  });
+}
 
-  return result;
+void NpcFactory::SaveToBinaryFile(const std::vector<std::shared_ptr<NPC>>& npcs,
+                                  const std::string& filename) {
+  WorldSnapshot::Save(npcs, filename);
+}
+
+std::vector<std::shared_ptr<NPC>> NpcFactory::LoadFromBinaryFile(const std::string& filename,
+                                                                 const MapBounds& bounds) {
+  return ReadSnapshot(filename, [&bounds](NpcType type, const std::string& name, int x, int y) {
+    return CreateNPC(type, name, x, y, bounds);
+  });
+}
+
+std::vector<std::shared_ptr<NPC>> NpcFactory::LoadFromBinaryFile(const std::string& filename,
+                                                                 NpcPool& pool,
+                                                                 const MapBounds& bounds) {
+  return ReadSnapshot(filename, [&](NpcType type, const std::string& name, int x, int y) {
+    return CreateNPC(type, name, x, y, pool, bounds);
+  });
 }
 
-}  // namespace lab7
\ No newline at end of file
+}  // namespace lab7
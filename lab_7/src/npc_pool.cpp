@@ -0,0 +1,83 @@
+#include "npc_pool.hpp"
+
+#include <algorithm>
+
+namespace lab7 {
+namespace {
+
+constexpr std::size_t kSlabAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+std::size_t RoundUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+NpcArena::NpcArena(std::size_t blocks_per_slab)
+    : blocks_per_slab_(blocks_per_slab > 0 ? blocks_per_slab : 1),
+      block_size_(0),
+      bump_(nullptr),
+      bump_end_(nullptr),
+      free_list_(nullptr) {}
+
+void* NpcArena::Allocate(std::size_t bytes, std::size_t alignment) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (block_size_ == 0) {
+    block_size_ = RoundUp(std::max(bytes, sizeof(void*)), kSlabAlignment);
+  }
+  if (bytes > block_size_ || alignment > kSlabAlignment) {
+    throw std::bad_alloc();
+  }
+
+  ++stats_.allocations;
+  if (free_list_) {
+    void* block = free_list_;
+    free_list_ = *static_cast<void**>(block);
+    return block;
+  }
+
+  if (bump_ == bump_end_) {
+    const std::size_t slab_bytes = block_size_ * blocks_per_slab_;
+    slabs_.emplace_back(new std::byte[slab_bytes]);
+    bump_ = slabs_.back().get();
+    bump_end_ = bump_ + slab_bytes;
+    ++stats_.slabs;
+    stats_.bytes_reserved += slab_bytes;
+  }
+  void* block = bump_;
+  bump_ += block_size_;
+  return block;
+}
+
+void NpcArena::Deallocate(void* block) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  *static_cast<void**>(block) = free_list_;
+  free_list_ = block;
+  ++stats_.deallocations;
+}
+
+PoolStats NpcArena::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+NpcPool::NpcPool(std::size_t blocks_per_slab) {
+  for (auto& arena : arenas_) {
+    arena = std::make_shared<NpcArena>(blocks_per_slab);
+  }
+}
+
+PoolStats NpcPool::GetStats() const {
+  PoolStats total;
+  for (const auto& arena : arenas_) {
+    const PoolStats stats = arena->GetStats();
+    total.allocations += stats.allocations;
+    total.deallocations += stats.deallocations;
+    total.slabs += stats.slabs;
+    total.bytes_reserved += stats.bytes_reserved;
+  }
+  return total;
+}
+
+}  // namespace lab7
@@ -1,55 +1,59 @@
 #include "observer.hpp"
 
 #include <iostream>
-#include <string_view>
-
-#include "npc.hpp"
-#include "npc_types.hpp"
+#include <utility>
 
 namespace lab7 {
 
-namespace {
+void IFightObserver::OnFights(std::span<const FightRecord> records) {
+  for (const FightRecord& record : records) {
+    OnFight(record);
+  }
+}
+
+std::mutex ConsoleObserver::cout_mutex_;
 
-constexpr std::string_view kMurderPrefix = "MURDER: ";
+ConsoleObserver::ConsoleObserver(NameLookup names, std::chrono::milliseconds flush_interval)
+    : log_(std::cout, std::move(names), flush_interval, &cout_mutex_) {}
 
-const char* NpcTypeToString(NpcType type) {
-  return NpcStats::GetTypeName(type);
+void ConsoleObserver::OnFight(const FightRecord& record) {
+  log_.Push(record);
 }
 
-}  // namespace
-
-std::mutex ConsoleObserver::cout_mutex_;
+void ConsoleObserver::OnFights(std::span<const FightRecord> records) {
+  log_.Push(records);
+}
 
-void ConsoleObserver::OnFight(const std::shared_ptr<NPC>& attacker,
-                               const std::shared_ptr<NPC>& defender,
-                               bool win) {
-  if (win) {
-    std::lock_guard<std::mutex> lock(cout_mutex_);
-    std::cout << kMurderPrefix << NpcTypeToString(attacker->GetType())
-              << " \"" << attacker->GetName() << "\" killed "
-              << NpcTypeToString(defender->GetType()) 
-              << " \"" << defender->GetName() << "\"" << std::endl;
-  }
+void ConsoleObserver::Flush() {
+  log_.Flush();
 }
 
-FileObserver::FileObserver(const std::string& filename) 
-    : log_file_(filename, std::ios::app) {}
+FileObserver::FileObserver(const std::string& filename, NameLookup names,
+                           std::chrono::milliseconds flush_interval)
+    : log_file_(filename, std::ios::app),
+      log_(log_file_, std::move(names), flush_interval) {}
 
 FileObserver::~FileObserver() {
+  log_.Flush();
   if (log_file_.is_open()) {
     log_file_.close();
   }
 }
 
-void FileObserver::OnFight(const std::shared_ptr<NPC>& attacker,
-                            const std::shared_ptr<NPC>& defender,
-                            bool win) {
-  if (win && log_file_.is_open()) {
-    log_file_ << kMurderPrefix << NpcTypeToString(attacker->GetType()) 
-              << " \"" << attacker->GetName() << "\" killed "
-              << NpcTypeToString(defender->GetType()) 
-              << " \"" << defender->GetName() << "\"" << std::endl;
+void FileObserver::OnFight(const FightRecord& record) {
+  if (log_file_.is_open()) {
+    log_.Push(record);
+  }
+}
+
+void FileObserver::OnFights(std::span<const FightRecord> records) {
+  if (log_file_.is_open()) {
+    log_.Push(records);
   }
 }
 
+void FileObserver::Flush() {
+  log_.Flush();
+}
+
 }  // namespace lab7
@@ -0,0 +1,118 @@
+#include "rng.hpp"
+
+#ifdef LAB7_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace lab7 {
+namespace {
+
+static_assert(Philox4x32({0, 0, 0, 0}, 0) ==
+              RandomBlock{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+
+using Filler = void (*)(std::uint64_t seed, RngStream stream, const std::uint32_t* entities,
+                        std::size_t count, std::uint64_t tick, RandomBlock* out);
+
+void FillScalar(std::uint64_t seed, RngStream stream, const std::uint32_t* entities,
+                std::size_t count, std::uint64_t tick, RandomBlock* out) {
+  for (std::size_t k = 0; k < count; ++k) {
+    out[k] = Philox4x32(MakeRngCounter(stream, entities[k], tick), seed);
+  }
+}
+
+#ifdef LAB7_X86_SIMD
+
+// 32x32->64 multiply of eight lanes: mul_epu32 covers the even lanes, the
+// odd ones are shifted down first.
+__attribute__((target("avx2"))) void MulHiLo(__m256i value, __m256i multiplier, __m256i& high,
+                                             __m256i& low) {
+  const __m256i even = _mm256_mul_epu32(value, multiplier);
+  const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(value, 32), multiplier);
+  low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+  high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+// Sixteen counters per iteration, one per lane of two independent groups so
+// the multiply latency of one hides behind the other; the words are
+// transposed into blocks on the way out.
+__attribute__((target("avx2"))) void FillAvx2(std::uint64_t seed, RngStream stream,
+                                              const std::uint32_t* entities, std::size_t count,
+                                              std::uint64_t tick, RandomBlock* out) {
+  constexpr std::size_t kGroups = 2;
+  const RandomBlock base = MakeRngCounter(stream, 0, tick);
+  const __m256i multiplier0 = _mm256_set1_epi32(static_cast<int>(0xD2511F53U));
+  const __m256i multiplier1 = _mm256_set1_epi32(static_cast<int>(0xCD9E8D57U));
+
+  std::size_t k = 0;
+  for (; k + 8 * kGroups <= count; k += 8 * kGroups) {
+    __m256i c0[kGroups], c1[kGroups], c2[kGroups], c3[kGroups];
+    for (std::size_t g = 0; g < kGroups; ++g) {
+      c0[g] = _mm256_set1_epi32(static_cast<int>(base[0]));
+      c1[g] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(entities + k + 8 * g));
+      c2[g] = _mm256_set1_epi32(static_cast<int>(base[2]));
+      c3[g] = _mm256_set1_epi32(static_cast<int>(base[3]));
+    }
+    auto key_lo = static_cast<std::uint32_t>(seed);
+    auto key_hi = static_cast<std::uint32_t>(seed >> 32);
+    for (int round = 0; round < 10; ++round) {
+      const __m256i round_key_lo = _mm256_set1_epi32(static_cast<int>(key_lo));
+      const __m256i round_key_hi = _mm256_set1_epi32(static_cast<int>(key_hi));
+      for (std::size_t g = 0; g < kGroups; ++g) {
+        __m256i high0, low0, high1, low1;
+        MulHiLo(c0[g], multiplier0, high0, low0);
+        MulHiLo(c2[g], multiplier1, high1, low1);
+        c0[g] = _mm256_xor_si256(_mm256_xor_si256(high1, c1[g]), round_key_lo);
+        c1[g] = low1;
+        c2[g] = _mm256_xor_si256(_mm256_xor_si256(high0, c3[g]), round_key_hi);
+        c3[g] = low0;
+      }
+      key_lo += 0x9E3779B9U;
+      key_hi += 0xBB67AE85U;
+    }
+
+    for (std::size_t g = 0; g < kGroups; ++g) {
+      alignas(32) std::uint32_t words[4][8];
+      _mm256_store_si256(reinterpret_cast<__m256i*>(words[0]), c0[g]);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(words[1]), c1[g]);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(words[2]), c2[g]);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(words[3]), c3[g]);
+      for (std::size_t lane = 0; lane < 8; ++lane) {
+        out[k + 8 * g + lane] = {words[0][lane], words[1][lane], words[2][lane], words[3][lane]};
+      }
+    }
+  }
+  FillScalar(seed, stream, entities + k, count - k, tick, out + k);
+}
+
+#endif  // LAB7_X86_SIMD
+
+Filler GetFiller(SimdLevel level) {
+#ifdef LAB7_X86_SIMD
+  switch (level) {
+    case SimdLevel::Scalar:
+    case SimdLevel::Sse2:
+      return FillScalar;
+    case SimdLevel::Avx2:
+      return FillAvx2;
+  }
+#else
+  (void)level;
+#endif
+  return FillScalar;
+}
+
+}  // namespace
+
+void FillRandomBlocks(std::uint64_t seed, RngStream stream, std::span<const std::uint32_t> entities,
+                      std::uint64_t tick, std::span<RandomBlock> out) {
+  static const Filler filler = GetFiller(GetSimdLevel());
+  filler(seed, stream, entities.data(), entities.size(), tick, out.data());
+}
+
+void FillRandomBlocks(SimdLevel level, std::uint64_t seed, RngStream stream,
+                      std::span<const std::uint32_t> entities, std::uint64_t tick,
+                      std::span<RandomBlock> out) {
+  GetFiller(level)(seed, stream, entities.data(), entities.size(), tick, out.data());
+}
+
+}  // namespace lab7
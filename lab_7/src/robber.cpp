@@ -5,8 +5,8 @@
 
 namespace lab7 {
 
-Robber::Robber(const std::string& name, int x, int y)
-    : NPC(NpcType::Robber, name, x, y) {}
+Robber::Robber(const std::string& name, int x, int y, MapBounds bounds)
+    : NPC(NpcType::Robber, name, x, y, bounds) {}
 
 bool Robber::Accept(std::shared_ptr<FightVisitor> visitor) {
   return visitor->Visit(std::dynamic_pointer_cast<Robber>(shared_from_this()));
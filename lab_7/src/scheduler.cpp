@@ -0,0 +1,182 @@
+#include "scheduler.hpp"
+
+#include <algorithm>
+
+namespace lab7 {
+
+void Task::promise_type::unhandled_exception() {
+  group->Fail(std::current_exception());
+}
+
+Task::~Task() {
+  if (handle_) {
+    handle_.destroy();
+  }
+}
+
+TaskGroup::TaskGroup(std::function<void()> on_error) : on_error_(std::move(on_error)) {}
+
+void TaskGroup::Finish() {
+  std::lock_guard<std::mutex> lock(scheduler_->mutex_);
+  if (--active_ == 0) {
+    // Notified under the lock: the group may be gone right after.
+    scheduler_->cv_.notify_all();
+  }
+}
+
+void TaskGroup::Fail(std::exception_ptr error) {
+  {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (error_) return;
+    error_ = std::move(error);
+  }
+  if (on_error_) on_error_();
+}
+
+std::exception_ptr TaskGroup::TakeError() {
+  std::lock_guard<std::mutex> lock(error_mutex_);
+  return std::exchange(error_, nullptr);
+}
+
+Scheduler::Scheduler(std::size_t worker_count) {
+  workers_.reserve(worker_count);
+  for (std::size_t i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this] {
+      std::unique_lock<std::mutex> lock(mutex_);
+      Drive(lock, [this] { return stopping_; });
+    });
+  }
+}
+
+Scheduler::~Scheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+std::size_t Scheduler::GetWorkerCount() const {
+  return workers_.size();
+}
+
+void Scheduler::Spawn(Task task, TaskGroup& group) {
+  const auto handle = std::exchange(task.handle_, {});
+  handle.promise().group = &group;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    group.scheduler_ = this;
+    ++group.active_;
+    ready_.push_back(handle);
+  }
+  cv_.notify_one();
+}
+
+void Scheduler::RunUntilDone(TaskGroup& group) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  Drive(lock, [&group] { return group.active_ == 0; });
+}
+
+void Scheduler::Schedule(std::coroutine_handle<> handle) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_.push_back(handle);
+  }
+  cv_.notify_one();
+}
+
+void Scheduler::AddTimer(EventWaiter& waiter, Clock::time_point deadline) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  waiter.timer = timers_.emplace(deadline, &waiter);
+  waiter.in_timers = true;
+  if (waiter.timer == timers_.begin()) {
+    // Sleeping threads wait for the previous earliest deadline.
+    cv_.notify_one();
+  }
+}
+
+void Scheduler::RemoveTimer(EventWaiter& waiter) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (waiter.in_timers) {
+    timers_.erase(waiter.timer);
+    waiter.in_timers = false;
+  }
+}
+
+template <typename Done>
+void Scheduler::Drive(std::unique_lock<std::mutex>& lock, Done done) {
+  while (!done()) {
+    const auto now = Clock::now();
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+      EventWaiter& waiter = *timers_.begin()->second;
+      timers_.erase(timers_.begin());
+      waiter.in_timers = false;
+      if (!waiter.claimed.exchange(true)) {
+        waiter.timed_out = true;
+        ready_.push_back(waiter.handle);
+      }
+    }
+
+    if (!ready_.empty()) {
+      const auto handle = ready_.front();
+      ready_.pop_front();
+      lock.unlock();
+      handle.resume();
+      lock.lock();
+    } else if (timers_.empty()) {
+      cv_.wait(lock);
+    } else {
+      // By value: while this thread sleeps, RemoveTimer() may erase the node.
+      const Clock::time_point deadline = timers_.begin()->first;
+      cv_.wait_until(lock, deadline);
+    }
+  }
+}
+
+AsyncEvent::AsyncEvent(Scheduler& scheduler) : scheduler_(scheduler) {}
+
+void AsyncEvent::Set() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  set_ = true;
+  for (EventWaiter* waiter : waiters_) {
+    if (!waiter->claimed.exchange(true)) {
+      scheduler_.Schedule(waiter->handle);
+    }
+  }
+  waiters_.clear();
+}
+
+void AsyncEvent::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  set_ = false;
+}
+
+bool AsyncEvent::IsSet() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return set_;
+}
+
+bool AsyncEvent::Suspend(EventWaiter& waiter, const Clock::time_point* deadline) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (set_) return false;
+  waiters_.push_back(&waiter);
+  // Still under the event lock, so Set() cannot resume the coroutine before
+  // its timer is registered.
+  if (deadline) {
+    scheduler_.AddTimer(waiter, *deadline);
+  }
+  return true;
+}
+
+void AsyncEvent::Remove(EventWaiter& waiter) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::erase(waiters_, &waiter);
+  }
+  scheduler_.RemoveTimer(waiter);
+}
+
+}  // namespace lab7
@@ -0,0 +1,38 @@
+#include "simd.hpp"
+
+namespace lab7 {
+namespace {
+
+SimdLevel DetectSimdLevel() {
+#ifdef LAB7_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+  if (__builtin_cpu_supports("sse2")) return SimdLevel::Sse2;
+#endif
+  return SimdLevel::Scalar;
+}
+
+}  // namespace
+
+SimdLevel GetSimdLevel() {
+  static const SimdLevel level = DetectSimdLevel();
+  return level;
+}
+
+const char* GetSimdLevelName(SimdLevel level) {
+  switch (level) {
+    case SimdLevel::Scalar:
+      return "scalar";
+    case SimdLevel::Sse2:
+      return "sse2";
+    case SimdLevel::Avx2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+bool IsSupported(SimdLevel level) {
+  return static_cast<int>(level) <= static_cast<int>(GetSimdLevel());
+}
+
+}  // namespace lab7
@@ -0,0 +1,131 @@
+#include "sparse_grid.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+
+namespace lab7 {
+namespace {
+
+constexpr std::size_t kMinSlots = 16;
+// Average entries per populated cell above which Build() shrinks the cells.
+constexpr std::size_t kMaxOccupancy = 2;
+
+// Side of a square holding one entry on average over the bounding box of
+// the entries, but at least min_size.
+int GetCellSizeFor(std::span<const int> xs, std::span<const int> ys, int min_size) {
+  if (xs.empty()) return min_size;
+  const auto [min_x, max_x] = std::minmax_element(xs.begin(), xs.end());
+  const auto [min_y, max_y] = std::minmax_element(ys.begin(), ys.end());
+  const double area = (static_cast<double>(*max_x) - *min_x + 1) *
+                      (static_cast<double>(*max_y) - *min_y + 1);
+  const double side = std::sqrt(area / static_cast<double>(xs.size()));
+  return std::max(min_size, static_cast<int>(side));
+}
+
+}  // namespace
+
+SparseGrid::SparseGrid(int min_cell_size)
+    : min_cell_size_(min_cell_size), cell_size_(min_cell_size) {
+  if (min_cell_size_ <= 0) {
+    throw std::invalid_argument("Grid requires a positive cell size");
+  }
+  Resize(kMinSlots);
+}
+
+void SparseGrid::Resize(std::size_t capacity) {
+  std::vector<Slot> old(capacity, Slot{kEmptyKey, kNoCell});
+  old.swap(slots_);
+  slot_shift_ = 64 - std::countr_zero(capacity);
+  const std::size_t mask = capacity - 1;
+  for (const Slot& entry : old) {
+    if (entry.key == kEmptyKey) continue;
+    std::size_t slot = GetHome(entry.key);
+    while (slots_[slot].key != kEmptyKey) slot = (slot + 1) & mask;
+    slots_[slot] = entry;
+  }
+}
+
+std::uint32_t SparseGrid::Insert(std::uint64_t key) {
+  if (2 * (cell_count_ + 1) > slots_.size()) Resize(2 * slots_.size());
+  const std::size_t mask = slots_.size() - 1;
+  for (std::size_t slot = GetHome(key);; slot = (slot + 1) & mask) {
+    if (slots_[slot].key == key) return slots_[slot].cell;
+    if (slots_[slot].key == kEmptyKey) {
+      slots_[slot] = Slot{key, static_cast<std::uint32_t>(cell_count_)};
+      cell_start_.push_back(0);
+      return static_cast<std::uint32_t>(cell_count_++);
+    }
+  }
+}
+
+void SparseGrid::AssignCells(std::span<const int> xs, std::span<const int> ys) {
+  // Start from the size the last build needed; positions change little
+  // between ticks, so the table rarely grows while filling.
+  const std::size_t capacity = std::bit_ceil(std::max(kMinSlots, 2 * cell_count_));
+  slots_.assign(capacity, Slot{kEmptyKey, kNoCell});
+  slot_shift_ = 64 - std::countr_zero(capacity);
+  cell_count_ = 0;
+  cell_start_.assign(1, 0);
+
+  entry_cell_.resize(xs.size());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    const std::uint32_t cell = Insert(GetKey(CellCoord(xs[i]), CellCoord(ys[i])));
+    entry_cell_[i] = cell;
+    ++cell_start_[cell + 1];
+  }
+}
+
+void SparseGrid::Build(std::span<const int> xs, std::span<const int> ys) {
+  const std::size_t count = std::min(xs.size(), ys.size());
+  xs = xs.first(count);
+  ys = ys.first(count);
+
+  // The bounding box overestimates the cells of a clustered population (a
+  // crowd plus one far-off entry would share a single cell), so cells
+  // shrink to the area the populated ones cover until they are about as
+  // full as for evenly spread entries. Each retry at least halves the size.
+  cell_size_ = GetCellSizeFor(xs, ys, min_cell_size_);
+  AssignCells(xs, ys);
+  while (cell_size_ > min_cell_size_ && count > kMaxOccupancy * cell_count_) {
+    const double scale = std::sqrt(static_cast<double>(cell_count_) / static_cast<double>(count));
+    cell_size_ = std::max(min_cell_size_, static_cast<int>(cell_size_ * scale));
+    AssignCells(xs, ys);
+  }
+  for (std::size_t c = 0; c < cell_count_; ++c) {
+    cell_start_[c + 1] += cell_start_[c];
+  }
+
+  entry_index_.resize(count);
+  entry_x_.resize(count);
+  entry_y_.resize(count);
+  cursor_.assign(cell_start_.begin(), cell_start_.end() - 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::uint32_t slot = cursor_[entry_cell_[i]]++;
+    entry_index_[slot] = static_cast<std::uint32_t>(i);
+    entry_x_[slot] = xs[i];
+    entry_y_[slot] = ys[i];
+  }
+}
+
+int SparseGrid::GetCellSize() const {
+  return cell_size_;
+}
+
+std::size_t SparseGrid::GetEntryCount() const {
+  return entry_index_.size();
+}
+
+std::size_t SparseGrid::GetCellCount() const {
+  return cell_count_;
+}
+
+std::size_t SparseGrid::GetMemoryUsage() const {
+  return slots_.capacity() * sizeof(Slot) +
+         (cell_start_.capacity() + entry_index_.capacity() + entry_cell_.capacity() +
+          cursor_.capacity()) * sizeof(std::uint32_t) +
+         (entry_x_.capacity() + entry_y_.capacity()) * sizeof(int);
+}
+
+}  // namespace lab7
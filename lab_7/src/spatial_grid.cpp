@@ -0,0 +1,63 @@
+#include "spatial_grid.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace lab7 {
+
+SpatialGrid::SpatialGrid(int map_size, int cell_size)
+    : map_size_(map_size), cell_size_(cell_size), cells_per_side_(0) {
+  if (map_size_ < 0 || cell_size_ <= 0) {
+    throw std::invalid_argument("Grid requires non-negative map size and positive cell size");
+  }
+  cells_per_side_ = map_size_ / cell_size_ + 1;
+  cell_start_.assign(static_cast<std::size_t>(cells_per_side_) * cells_per_side_ + 1, 0);
+}
+
+int SpatialGrid::CellCoord(int value) const {
+  return std::clamp(value, 0, map_size_) / cell_size_;
+}
+
+void SpatialGrid::Build(std::span<const int> xs, std::span<const int> ys) {
+  const std::size_t count = std::min(xs.size(), ys.size());
+  const std::size_t cell_count = cell_start_.size() - 1;
+
+  entry_cell_.resize(count);
+  std::fill(cell_start_.begin(), cell_start_.end(), 0);
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::size_t cell =
+        static_cast<std::size_t>(CellCoord(ys[i])) * cells_per_side_ + CellCoord(xs[i]);
+    entry_cell_[i] = static_cast<std::uint32_t>(cell);
+    ++cell_start_[cell + 1];
+  }
+  for (std::size_t c = 0; c < cell_count; ++c) {
+    cell_start_[c + 1] += cell_start_[c];
+  }
+
+  entry_index_.resize(count);
+  entry_x_.resize(count);
+  entry_y_.resize(count);
+  cursor_.assign(cell_start_.begin(), cell_start_.end() - 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    const std::uint32_t slot = cursor_[entry_cell_[i]]++;
+    entry_index_[slot] = static_cast<std::uint32_t>(i);
+    entry_x_[slot] = xs[i];
+    entry_y_[slot] = ys[i];
+  }
+}
+
+int SpatialGrid::GetCellSize() const {
+  return cell_size_;
+}
+
+std::size_t SpatialGrid::GetEntryCount() const {
+  return entry_index_.size();
+}
+
+std::size_t SpatialGrid::GetMemoryUsage() const {
+  return (cell_start_.capacity() + entry_index_.capacity() + entry_cell_.capacity() +
+          cursor_.capacity()) * sizeof(std::uint32_t) +
+         (entry_x_.capacity() + entry_y_.capacity()) * sizeof(int);
+}
+
+}  // namespace lab7
@@ -0,0 +1,134 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace lab7 {
+namespace {
+
+constexpr std::size_t kChunksPerThread = 4;
+
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+    : queued_(0), next_worker_(0), stop_(false) {
+  const std::size_t worker_count = std::max<std::size_t>(thread_count, 1) - 1;
+  for (std::size_t i = 0; i < worker_count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (std::size_t i = 0; i < worker_count; ++i) {
+    threads_.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stop_ = true;
+  }
+  wake_cv_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+std::size_t ThreadPool::GetThreadCount() const {
+  return workers_.size() + 1;
+}
+
+void ThreadPool::WorkerLoop(std::size_t self) {
+  while (true) {
+    if (TryRunOne(self)) continue;
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_cv_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    if (stop_ && queued_ == 0) return;
+  }
+}
+
+bool ThreadPool::TryRunOne(std::size_t self) {
+  std::function<void()> task;
+
+  if (self < workers_.size()) {
+    auto& own = *workers_[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+    }
+  }
+
+  for (std::size_t i = 1; !task && i <= workers_.size(); ++i) {
+    auto& victim = *workers_[(self + i) % workers_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+    }
+  }
+
+  if (!task) return false;
+  --queued_;
+  task();
+  return true;
+}
+
+void ThreadPool::Push(std::function<void()> task) {
+  auto& worker = *workers_[next_worker_++ % workers_.size()];
+  {
+    // Counted under the deque's lock, so a woken worker finds the task and
+    // nobody pops it before it is counted.
+    std::lock_guard<std::mutex> wake_lock(wake_mutex_);
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+    ++queued_;
+  }
+  wake_cv_.notify_one();
+}
+
+std::size_t ThreadPool::GetChunkCount(std::size_t count, std::size_t min_chunk) const {
+  if (count == 0) return 0;
+  const std::size_t grain = std::max<std::size_t>(min_chunk, 1);
+  const std::size_t by_size = (count + grain - 1) / grain;
+  return std::clamp<std::size_t>(by_size, 1, GetThreadCount() * kChunksPerThread);
+}
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t min_chunk,
+                             const std::function<void(std::size_t, std::size_t, std::size_t)>& fn) {
+  const std::size_t chunks = GetChunkCount(count, min_chunk);
+  if (chunks <= 1 || workers_.empty()) {
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+      fn(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+    }
+    return;
+  }
+
+  // Tasks refer to this frame, so the caller waits for every chunk, even
+  // after a failure, and rethrows the first exception only then.
+  std::atomic<std::size_t> remaining(chunks);
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+    Push([&fn, &remaining, &error_mutex, &error, chunk, chunks, count] {
+      try {
+        fn(chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = std::current_exception();
+      }
+      remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  const std::size_t caller = workers_.size();
+  while (remaining.load(std::memory_order_acquire) > 0) {
+    if (!TryRunOne(caller)) {
+      std::this_thread::yield();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+}  // namespace lab7
@@ -0,0 +1,298 @@
+#include "world.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+
+#include "rng.hpp"
+
+namespace lab7 {
+namespace {
+
+template <typename T>
+T LoadRelaxed(const std::vector<T>& values, EntityId id) {
+  return std::atomic_ref<T>(const_cast<T&>(values[id])).load(std::memory_order_relaxed);
+}
+
+template <typename T>
+void StoreRelaxed(std::vector<T>& values, EntityId id, T value) {
+  std::atomic_ref<T>(values[id]).store(value, std::memory_order_relaxed);
+}
+
+// Compact once this share of the live list is dead, but not for a handful.
+constexpr std::size_t kCompactDivisor = 8;
+constexpr std::size_t kMinCompactCount = 64;
+constexpr std::size_t kBitsPerWord = 64;
+
+}  // namespace
+
+EntityId World::Add(NpcType type, int x, int y, std::string_view name) {
+  std::uint32_t name_id = kGeneratedName;
+  if (!name.empty()) {
+    name_id = static_cast<std::uint32_t>(names_.size());
+    names_.emplace_back(name);
+  }
+
+  EntityId id;
+  if (!free_.empty()) {
+    id = free_.back();
+    free_.pop_back();
+    x_[id] = x;
+    y_[id] = y;
+    type_[id] = type;
+    alive_[id] = 1;
+    roll_count_[id] = 0;
+    name_id_[id] = name_id;
+  } else {
+    if (x_.size() % kBitsPerWord == 0) changed_.push_back(0);
+    id = static_cast<EntityId>(x_.size());
+    x_.push_back(x);
+    y_.push_back(y);
+    type_.push_back(type);
+    alive_.push_back(1);
+    roll_count_.push_back(0);
+    claimed_.push_back(0);
+    name_id_.push_back(name_id);
+    generation_.push_back(0);
+  }
+  live_.push_back(id);
+  MarkChanged(id);
+  layout_changed_ = true;
+  return id;
+}
+
+void World::Reserve(std::size_t count) {
+  x_.reserve(count);
+  y_.reserve(count);
+  type_.reserve(count);
+  alive_.reserve(count);
+  name_id_.reserve(count);
+  roll_count_.reserve(count);
+  claimed_.reserve(count);
+  generation_.reserve(count);
+  live_.reserve(count);
+  changed_.reserve((count + kBitsPerWord - 1) / kBitsPerWord);
+}
+
+void World::Clear() {
+  x_.clear();
+  y_.clear();
+  type_.clear();
+  alive_.clear();
+  name_id_.clear();
+  names_.clear();
+  roll_count_.clear();
+  claimed_.clear();
+  generation_.clear();
+  live_.clear();
+  free_.clear();
+  changed_.clear();
+  layout_changed_ = true;
+  pending_dead_ = 0;
+}
+
+void World::Resize(std::size_t count) {
+  x_.resize(count, 0);
+  y_.resize(count, 0);
+  type_.resize(count, NpcType::Unknown);
+  alive_.resize(count, 0);
+  name_id_.resize(count, kGeneratedName);
+  roll_count_.resize(count, 0);
+  claimed_.resize(count, 0);
+  generation_.resize(count, 0);
+  changed_.resize((count + kBitsPerWord - 1) / kBitsPerWord, 0);
+}
+
+std::size_t World::Size() const {
+  return x_.size();
+}
+
+std::span<const EntityId> World::LiveIds() const {
+  return live_;
+}
+
+std::size_t World::GetPendingDeadCount() const {
+  return pending_dead_.load(std::memory_order_relaxed);
+}
+
+bool World::ShouldCompact() const {
+  const std::size_t dead = GetPendingDeadCount();
+  return dead >= kMinCompactCount && dead * kCompactDivisor >= live_.size();
+}
+
+std::size_t World::Compact() {
+  const auto end = std::stable_partition(live_.begin(), live_.end(),
+                                         [this](EntityId id) { return IsAlive(id); });
+  for (auto it = end; it != live_.end(); ++it) {
+    StoreRelaxed(generation_, *it, generation_[*it] + 1);
+    free_.push_back(*it);
+    MarkChanged(*it);
+  }
+  layout_changed_ = true;
+  const auto removed = static_cast<std::size_t>(live_.end() - end);
+  live_.erase(end, live_.end());
+  pending_dead_.fetch_sub(static_cast<std::uint32_t>(removed), std::memory_order_relaxed);
+  return removed;
+}
+
+EntityHandle World::GetHandle(EntityId id) const {
+  return EntityHandle{id, LoadRelaxed(generation_, id)};
+}
+
+bool World::IsCurrent(EntityHandle handle) const {
+  return handle.id < generation_.size() && LoadRelaxed(generation_, handle.id) == handle.generation;
+}
+
+void World::SetSeed(std::uint64_t seed) {
+  seed_ = seed;
+}
+
+std::uint64_t World::GetSeed() const {
+  return seed_;
+}
+
+void World::SetBounds(MapBounds bounds) {
+  bounds_ = bounds;
+}
+
+const MapBounds& World::GetBounds() const {
+  return bounds_;
+}
+
+int World::GetX(EntityId id) const {
+  return LoadRelaxed(x_, id);
+}
+
+int World::GetY(EntityId id) const {
+  return LoadRelaxed(y_, id);
+}
+
+void World::SetPosition(EntityId id, int x, int y) {
+  if (LoadRelaxed(x_, id) == x && LoadRelaxed(y_, id) == y) return;
+  StoreRelaxed(x_, id, x);
+  StoreRelaxed(y_, id, y);
+  MarkChanged(id);
+}
+
+NpcType World::GetType(EntityId id) const {
+  return type_[id];
+}
+
+std::string World::GetName(EntityId id) const {
+  const std::uint32_t name_id = name_id_[id];
+  if (name_id == kGeneratedName) {
+    return "NPC" + std::to_string(id);
+  }
+  return names_[name_id];
+}
+
+std::string_view World::GetStoredName(EntityId id) const {
+  const std::uint32_t name_id = name_id_[id];
+  if (name_id == kGeneratedName) {
+    return {};
+  }
+  return names_[name_id];
+}
+
+bool World::IsAlive(EntityId id) const {
+  return LoadRelaxed(alive_, id) != 0;
+}
+
+bool World::Kill(EntityId id) {
+  if (std::atomic_ref<std::uint8_t>(alive_[id]).exchange(0, std::memory_order_acq_rel) == 0) {
+    return false;
+  }
+  pending_dead_.fetch_add(1, std::memory_order_relaxed);
+  MarkChanged(id);
+  return true;
+}
+
+bool World::TryClaim(EntityId id) {
+  return std::atomic_ref<std::uint8_t>(claimed_[id]).exchange(1, std::memory_order_acquire) == 0;
+}
+
+void World::Release(EntityId id) {
+  std::atomic_ref<std::uint8_t>(claimed_[id]).store(0, std::memory_order_release);
+}
+
+int World::RollDice(EntityId id) {
+  const std::uint32_t roll =
+      std::atomic_ref<std::uint32_t>(roll_count_[id]).fetch_add(1, std::memory_order_relaxed);
+  MarkChanged(id);
+  return CounterRng(seed_, RngStream::Dice, id, roll).NextInt(1, 6);
+}
+
+void World::MarkChanged(EntityId id) {
+  // Most marks hit a bit that is already set; skip the read-modify-write.
+  std::atomic_ref<std::uint64_t> word(changed_[id / kBitsPerWord]);
+  const std::uint64_t bit = std::uint64_t{1} << (id % kBitsPerWord);
+  if ((word.load(std::memory_order_relaxed) & bit) == 0) {
+    word.fetch_or(bit, std::memory_order_relaxed);
+  }
+}
+
+EntityState World::GetState(EntityId id) const {
+  return EntityState{GetX(id), GetY(id), type_[id], IsAlive(id), roll_count_[id],
+                     generation_[id], GetStoredName(id)};
+}
+
+void World::SetState(EntityId id, const EntityState& state) {
+  if (id >= Size()) Resize(static_cast<std::size_t>(id) + 1);
+  x_[id] = state.x;
+  y_[id] = state.y;
+  type_[id] = state.type;
+  alive_[id] = state.alive ? 1 : 0;
+  roll_count_[id] = state.roll_count;
+  claimed_[id] = 0;
+  generation_[id] = state.generation;
+  if (state.name.empty()) {
+    name_id_[id] = kGeneratedName;
+  } else if (GetStoredName(id) != state.name) {
+    name_id_[id] = static_cast<std::uint32_t>(names_.size());
+    names_.emplace_back(state.name);
+  }
+}
+
+std::span<const EntityId> World::FreeIds() const {
+  return free_;
+}
+
+void World::SetLayout(std::span<const EntityId> live, std::span<const EntityId> free) {
+  live_.assign(live.begin(), live.end());
+  free_.assign(free.begin(), free.end());
+}
+
+void World::SetPendingDeadCount(std::size_t count) {
+  pending_dead_ = static_cast<std::uint32_t>(count);
+}
+
+void World::GetChangedIds(std::vector<EntityId>& ids) const {
+  for (std::size_t word = 0; word < changed_.size(); ++word) {
+    for (std::uint64_t bits = changed_[word]; bits != 0; bits &= bits - 1) {
+      ids.push_back(static_cast<EntityId>(word * kBitsPerWord + std::countr_zero(bits)));
+    }
+  }
+}
+
+bool World::IsLayoutChanged() const {
+  return layout_changed_;
+}
+
+void World::ClearChanges() {
+  std::fill(changed_.begin(), changed_.end(), 0);
+  layout_changed_ = false;
+}
+
+std::span<const int> World::Xs() const {
+  return x_;
+}
+
+std::span<const int> World::Ys() const {
+  return y_;
+}
+
+std::span<const NpcType> World::Types() const {
+  return type_;
+}
+
+}  // namespace lab7
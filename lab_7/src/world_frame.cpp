@@ -0,0 +1,107 @@
+#include "world_frame.hpp"
+
+#include <thread>
+#include <utility>
+
+#include "world.hpp"
+
+namespace lab7 {
+
+std::uint64_t WorldFrame::GetTick() const {
+  return tick_;
+}
+
+std::span<const FrameEntry> WorldFrame::Entries() const {
+  return entries_;
+}
+
+std::size_t WorldFrame::Size() const {
+  return entries_.size();
+}
+
+std::string WorldFrame::GetName(EntityId id) const {
+  return world_ ? world_->GetName(id) : "NPC" + std::to_string(id);
+}
+
+FrameView::FrameView(const FrameBuffer* buffer, std::size_t slot) : buffer_(buffer), slot_(slot) {}
+
+FrameView::~FrameView() {
+  if (buffer_) buffer_->Release(slot_);
+}
+
+FrameView::FrameView(FrameView&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, nullptr)), slot_(other.slot_) {}
+
+FrameView& FrameView::operator=(FrameView&& other) noexcept {
+  if (this != &other) {
+    if (buffer_) buffer_->Release(slot_);
+    buffer_ = std::exchange(other.buffer_, nullptr);
+    slot_ = other.slot_;
+  }
+  return *this;
+}
+
+const WorldFrame& FrameView::operator*() const {
+  return buffer_->slots_[slot_].frame;
+}
+
+const WorldFrame* FrameView::operator->() const {
+  return &buffer_->slots_[slot_].frame;
+}
+
+FrameView FrameBuffer::Acquire() const {
+  while (true) {
+    const std::size_t slot = published_.load(std::memory_order_seq_cst);
+    slots_[slot].readers.fetch_add(1, std::memory_order_seq_cst);
+    // The writer only overwrites unpublished, unpinned slots, so a slot
+    // that is still published after pinning it is safe to read.
+    if (published_.load(std::memory_order_seq_cst) == slot) {
+      return FrameView(this, slot);
+    }
+    slots_[slot].readers.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void FrameBuffer::Release(std::size_t slot) const {
+  slots_[slot].readers.fetch_sub(1, std::memory_order_release);
+}
+
+bool FrameBuffer::Publish(const World& world, std::uint64_t tick) {
+  const std::size_t published = published_.load(std::memory_order_relaxed);
+  for (std::size_t slot = 0; slot < kSlotCount; ++slot) {
+    if (slot == published || slots_[slot].readers.load(std::memory_order_seq_cst) != 0) {
+      continue;
+    }
+
+    WorldFrame& frame = slots_[slot].frame;
+    frame.tick_ = tick;
+    frame.world_ = &world;
+    frame.entries_.clear();
+    for (const EntityId id : world.LiveIds()) {
+      if (world.IsAlive(id)) {
+        frame.entries_.push_back(FrameEntry{id, world.GetType(id), world.GetX(id), world.GetY(id)});
+      }
+    }
+    published_.store(slot, std::memory_order_seq_cst);
+    return true;
+  }
+  return false;
+}
+
+void FrameBuffer::Clear() {
+  const std::size_t published = published_.load(std::memory_order_relaxed);
+  const std::size_t next = (published + 1) % kSlotCount;
+  while (slots_[next].readers.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+  slots_[next].frame = WorldFrame();
+  published_.store(next, std::memory_order_seq_cst);
+
+  for (std::size_t slot = 0; slot < kSlotCount; ++slot) {
+    while (slot != next && slots_[slot].readers.load(std::memory_order_seq_cst) != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+}  // namespace lab7
@@ -0,0 +1,160 @@
+#include "world_snapshot.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include "checksum.hpp"
+#include "mapped_file.hpp"
+#include "world.hpp"
+
+namespace lab7 {
+namespace {
+
+std::uint64_t ChecksumPayload(std::span<const SnapshotRecord> records, std::string_view strings) {
+  std::uint64_t hash = Checksum(reinterpret_cast<const char*>(records.data()),
+                                records.size_bytes(), records.size());
+  return Checksum(strings.data(), strings.size(), hash);
+}
+
+class SnapshotWriter {
+ private:
+  std::vector<SnapshotRecord> records_;
+  std::string strings_;
+
+ public:
+  explicit SnapshotWriter(std::size_t count) {
+    records_.reserve(count);
+  }
+
+  void Add(NpcType type, int x, int y, bool alive, std::string_view name) {
+    SnapshotRecord record{};
+    record.x = x;
+    record.y = y;
+    record.type = type;
+    record.alive = alive ? 1 : 0;
+    if (name.empty()) {
+      record.name_offset = WorldSnapshot::kGeneratedName;
+    } else {
+      if (strings_.size() + name.size() > UINT32_MAX) {
+        throw std::length_error("Snapshot string table is too large");
+      }
+      record.name_offset = static_cast<std::uint32_t>(strings_.size());
+      record.name_length = static_cast<std::uint32_t>(name.size());
+      strings_ += name;
+    }
+    records_.push_back(record);
+  }
+
+  void Write(const std::string& filename) const {
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs.is_open()) {
+      throw std::runtime_error("Cannot open file for writing: " + filename);
+    }
+
+    SnapshotHeader header{};
+    std::copy(std::begin(WorldSnapshot::kMagic), std::end(WorldSnapshot::kMagic), header.magic);
+    header.version = WorldSnapshot::kVersion;
+    header.record_size = sizeof(SnapshotRecord);
+    header.record_count = records_.size();
+    header.string_table_size = strings_.size();
+    header.checksum = ChecksumPayload(records_, strings_);
+
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(records_.data()),
+              static_cast<std::streamsize>(records_.size() * sizeof(SnapshotRecord)));
+    ofs.write(strings_.data(), static_cast<std::streamsize>(strings_.size()));
+    if (!ofs) {
+      throw std::runtime_error("Cannot write snapshot: " + filename);
+    }
+  }
+};
+
+}  // namespace
+
+WorldSnapshot::WorldSnapshot(const std::string& filename)
+    : file_(std::make_unique<MappedFile>(filename)) {
+  if (file_->Size() < sizeof(SnapshotHeader)) {
+    throw std::runtime_error("Not a snapshot file: " + filename);
+  }
+  file_->AdviseSequential();
+
+  const char* bytes = file_->Data();
+  header_ = reinterpret_cast<const SnapshotHeader*>(bytes);
+  if (!std::equal(std::begin(kMagic), std::end(kMagic), header_->magic)) {
+    throw std::runtime_error("Not a snapshot file: " + filename);
+  }
+  if (header_->version != kVersion || header_->record_size != sizeof(SnapshotRecord)) {
+    throw std::runtime_error("Unsupported snapshot version: " + filename);
+  }
+
+  const std::size_t payload = file_->Size() - sizeof(SnapshotHeader);
+  if (header_->record_count > payload / sizeof(SnapshotRecord) ||
+      header_->string_table_size !=
+          payload - header_->record_count * sizeof(SnapshotRecord)) {
+    throw std::runtime_error("Truncated snapshot: " + filename);
+  }
+
+  records_ = {reinterpret_cast<const SnapshotRecord*>(bytes + sizeof(SnapshotHeader)),
+              static_cast<std::size_t>(header_->record_count)};
+  strings_ = {bytes + sizeof(SnapshotHeader) + records_.size_bytes(),
+              static_cast<std::size_t>(header_->string_table_size)};
+  if (ChecksumPayload(records_, strings_) != header_->checksum) {
+    throw std::runtime_error("Snapshot checksum mismatch: " + filename);
+  }
+}
+
+WorldSnapshot::~WorldSnapshot() = default;
+
+void WorldSnapshot::Save(const World& world, const std::string& filename) {
+  SnapshotWriter writer(world.Size());
+  for (EntityId id = 0; id < world.Size(); ++id) {
+    writer.Add(world.GetType(id), world.GetX(id), world.GetY(id), world.IsAlive(id),
+               world.GetStoredName(id));
+  }
+  writer.Write(filename);
+}
+
+void WorldSnapshot::Save(const std::vector<std::shared_ptr<NPC>>& npcs,
+                         const std::string& filename) {
+  SnapshotWriter writer(npcs.size());
+  for (const auto& npc : npcs) {
+    writer.Add(npc->GetType(), npc->GetX(), npc->GetY(), npc->IsAlive(), npc->GetName());
+  }
+  writer.Write(filename);
+}
+
+std::size_t WorldSnapshot::Size() const {
+  return records_.size();
+}
+
+std::span<const SnapshotRecord> WorldSnapshot::Records() const {
+  return records_;
+}
+
+std::string_view WorldSnapshot::GetName(const SnapshotRecord& record) const {
+  if (record.name_offset == kGeneratedName) {
+    return {};
+  }
+  if (record.name_offset > strings_.size() ||
+      record.name_length > strings_.size() - record.name_offset) {
+    throw std::runtime_error("Snapshot name is out of range");
+  }
+  return strings_.substr(record.name_offset, record.name_length);
+}
+
+void WorldSnapshot::LoadInto(World& world) const {
+  world.Reserve(world.Size() + records_.size());
+  for (const auto& record : records_) {
+    if (record.type != NpcType::Bear && record.type != NpcType::Elf &&
+        record.type != NpcType::Robber) {
+      throw std::invalid_argument("Unknown NPC type");
+    }
+    const EntityId id = world.Add(record.type, record.x, record.y, GetName(record));
+    if (!record.alive) {
+      world.Kill(id);
+    }
+  }
+}
+
+}  // namespace lab7
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "checkpoint.hpp"
+#include "world.hpp"
+
+namespace {
+
+constexpr lab7::EntityId kEntityCount = 200;
+
+void Populate(lab7::World& world) {
+  world.SetSeed(99);
+  for (lab7::EntityId id = 0; id < kEntityCount; ++id) {
+    const auto type = static_cast<lab7::NpcType>(id % 3 + 1);
+    const std::string name = id % 4 == 0 ? "npc" + std::to_string(id) : std::string();
+    world.Add(type, static_cast<int>(id), static_cast<int>(id * 3 % 101), name);
+  }
+}
+
+void ExpectSameWorld(const lab7::World& expected, const lab7::World& actual) {
+  ASSERT_EQ(actual.Size(), expected.Size());
+  EXPECT_EQ(actual.GetSeed(), expected.GetSeed());
+  EXPECT_EQ(actual.GetPendingDeadCount(), expected.GetPendingDeadCount());
+  for (lab7::EntityId id = 0; id < expected.Size(); ++id) {
+    const lab7::EntityState want = expected.GetState(id);
+    const lab7::EntityState got = actual.GetState(id);
+    EXPECT_EQ(got.x, want.x) << "entity " << id;
+    EXPECT_EQ(got.y, want.y) << "entity " << id;
+    EXPECT_EQ(got.type, want.type) << "entity " << id;
+    EXPECT_EQ(got.alive, want.alive) << "entity " << id;
+    EXPECT_EQ(got.roll_count, want.roll_count) << "entity " << id;
+    EXPECT_EQ(got.generation, want.generation) << "entity " << id;
+    EXPECT_EQ(got.name, want.name) << "entity " << id;
+  }
+  const auto live = expected.LiveIds();
+  const auto free = expected.FreeIds();
+  EXPECT_EQ(std::vector<lab7::EntityId>(actual.LiveIds().begin(), actual.LiveIds().end()),
+            std::vector<lab7::EntityId>(live.begin(), live.end()));
+  EXPECT_EQ(std::vector<lab7::EntityId>(actual.FreeIds().begin(), actual.FreeIds().end()),
+            std::vector<lab7::EntityId>(free.begin(), free.end()));
+}
+
+}  // namespace
+
+TEST(CheckpointTest, FullFrameRoundTrips) {
+  lab7::World world;
+  Populate(world);
+  world.RollDice(3);
+  world.Kill(7);
+  lab7::CheckpointState state;
+  state.tick = 12;
+  state.cooldowns.push_back({(std::uint64_t{1} << 32) | 2, 10});
+
+  std::stringstream stream;
+  const lab7::CheckpointInfo info = lab7::CheckpointFile::Write(stream, world, state, true);
+  EXPECT_TRUE(info.full);
+  EXPECT_EQ(info.entities, kEntityCount);
+  EXPECT_EQ(info.bytes, stream.str().size());
+
+  lab7::World restored;
+  const lab7::CheckpointState read = lab7::CheckpointFile::Read(stream, restored);
+  EXPECT_EQ(read.tick, 12U);
+  ASSERT_EQ(read.cooldowns.size(), 1U);
+  EXPECT_EQ(read.cooldowns[0].pair, state.cooldowns[0].pair);
+  EXPECT_EQ(read.cooldowns[0].tick, 10U);
+  ExpectSameWorld(world, restored);
+}
+
+// Deltas carry only what changed, including a compaction that rewrites the
+// live and free lists and slots reused afterwards; replaying the chain
+// gives back the final world, and a reader can keep appending to it.
+TEST(CheckpointTest, DeltaFramesReplayToTheLastState) {
+  lab7::World world;
+  Populate(world);
+  std::stringstream stream;
+  lab7::CheckpointState state;
+  lab7::CheckpointFile::Write(stream, world, state, true);
+
+  state.tick = 1;
+  world.SetPosition(5, 50, 60);
+  world.RollDice(6);
+  const lab7::CheckpointInfo moved = lab7::CheckpointFile::Write(stream, world, state, false);
+  EXPECT_FALSE(moved.full);
+  EXPECT_EQ(moved.entities, 2U);
+
+  state.tick = 2;
+  for (lab7::EntityId id = 10; id < 80; ++id) {
+    world.Kill(id);
+  }
+  lab7::CheckpointFile::Write(stream, world, state, false);
+
+  state.tick = 3;
+  world.Compact();
+  world.Add(lab7::NpcType::Elf, 1, 2, "reused");
+  lab7::CheckpointFile::Write(stream, world, state, false);
+
+  lab7::World restored;
+  EXPECT_EQ(lab7::CheckpointFile::Read(stream, restored).tick, 3U);
+  ExpectSameWorld(world, restored);
+
+  state.tick = 4;
+  restored.SetPosition(0, 9, 9);
+  world.SetPosition(0, 9, 9);
+  std::stringstream next(stream.str(), std::ios::in | std::ios::out | std::ios::app);
+  EXPECT_EQ(lab7::CheckpointFile::Write(next, restored, state, false).entities, 1U);
+  lab7::World replayed;
+  EXPECT_EQ(lab7::CheckpointFile::Read(next, replayed).tick, 4U);
+  ExpectSameWorld(world, replayed);
+}
+
+TEST(CheckpointTest, ChecksumCoversTheHeader) {
+  lab7::World world;
+  Populate(world);
+  std::stringstream stream;
+  lab7::CheckpointFile::Write(stream, world, lab7::CheckpointState{}, true);
+
+  std::string bytes = stream.str();
+  bytes[offsetof(lab7::CheckpointHeader, seed)] ^= 1;
+  std::stringstream corrupt(bytes);
+  lab7::World restored;
+  EXPECT_THROW(lab7::CheckpointFile::Read(corrupt, restored), std::runtime_error);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "combat_system.hpp"
+#include "rng.hpp"
+#include "world.hpp"
+
+namespace {
+
+constexpr lab7::EntityId kEntityCount = 256;
+constexpr std::size_t kTaskCount = 50000;
+
+void Populate(lab7::World& world, std::vector<lab7::CombatTask>& tasks) {
+  world.Clear();
+  world.SetSeed(7);
+  // Mostly bears, which cannot kill each other, so claims stay contested
+  // for the whole run instead of only until the victims are gone.
+  for (lab7::EntityId id = 0; id < kEntityCount; ++id) {
+    const auto type = id % 8 == 0 ? lab7::NpcType::Elf
+                      : id % 8 == 1 ? lab7::NpcType::Robber
+                                    : lab7::NpcType::Bear;
+    world.Add(type, 0, 0);
+  }
+  tasks.clear();
+  for (std::size_t i = 0; tasks.size() < kTaskCount; ++i) {
+    lab7::CounterRng rng(7, lab7::RngStream::Spawn, i, 1);
+    const auto a = static_cast<lab7::EntityId>(rng.NextInt(0, kEntityCount - 1));
+    const auto b = static_cast<lab7::EntityId>(rng.NextInt(0, kEntityCount - 1));
+    if (a != b) tasks.push_back(lab7::CombatTask{a, b, i});
+  }
+}
+
+}  // namespace
+
+// Every thread fights the same few hundred entities, as combat workers do
+// through the queue: nobody dies twice, dead entities never win, and each
+// kill record matches exactly one dead entity.
+TEST(CombatSystemTest, ClaimedResolutionKeepsInvariantsUnderContention) {
+  lab7::World world;
+  std::vector<lab7::CombatTask> tasks;
+
+  for (const std::size_t thread_count : {2, 4, 8}) {
+    SCOPED_TRACE(thread_count);
+    Populate(world, tasks);
+    std::vector<std::atomic<std::uint32_t>> deaths(kEntityCount);
+    std::atomic<std::size_t> dead_winners{0};
+    std::atomic<std::size_t> kills{0};
+
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < thread_count; ++t) {
+      workers.emplace_back([&, t] {
+        auto on_fight = [&](const lab7::FightRecord& record) {
+          if (!lab7::CombatSystem::IsKill(record.outcome)) return;
+          const bool attacker_won = record.outcome == lab7::CombatOutcome::AttackerWon;
+          const lab7::EntityId winner = attacker_won ? record.attacker : record.defender;
+          if (!world.IsAlive(winner)) dead_winners.fetch_add(1);
+          deaths[attacker_won ? record.defender : record.attacker].fetch_add(1);
+          kills.fetch_add(1);
+        };
+        for (std::size_t i = t; i < tasks.size(); i += thread_count) {
+          lab7::CombatSystem::ResolveClaimed(world, tasks[i], on_fight);
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    std::size_t dead = 0;
+    for (lab7::EntityId id = 0; id < kEntityCount; ++id) {
+      const bool alive = world.IsAlive(id);
+      dead += !alive;
+      EXPECT_EQ(deaths[id].load(), alive ? 0U : 1U) << "entity " << id;
+    }
+    EXPECT_EQ(dead_winners.load(), 0U);
+    EXPECT_EQ(kills.load(), dead);
+    EXPECT_GT(dead, 0U);
+  }
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "fight_journal.hpp"
+#include "world.hpp"
+
+namespace {
+
+void ExpectSameFight(const lab7::FightRecord& expected, const lab7::FightRecord& actual) {
+  EXPECT_EQ(actual.tick, expected.tick);
+  EXPECT_EQ(actual.attacker, expected.attacker);
+  EXPECT_EQ(actual.defender, expected.defender);
+  EXPECT_EQ(actual.attacker_type, expected.attacker_type);
+  EXPECT_EQ(actual.defender_type, expected.defender_type);
+  EXPECT_EQ(actual.outcome, expected.outcome);
+  EXPECT_EQ(actual.rolls, expected.rolls);
+}
+
+lab7::FightRecord MakeFight(std::uint64_t tick, lab7::EntityId attacker,
+                            lab7::EntityId defender, lab7::CombatOutcome outcome) {
+  return lab7::FightRecord{tick,
+                           attacker,
+                           defender,
+                           static_cast<lab7::NpcType>(attacker % 3 + 1),
+                           static_cast<lab7::NpcType>(defender % 3 + 1),
+                           outcome,
+                           {static_cast<std::uint8_t>(tick % 6 + 1), 6, 1,
+                            static_cast<std::uint8_t>(attacker % 6 + 1)}};
+}
+
+std::string TempPath(const std::string& name) {
+  return testing::TempDir() + name;
+}
+
+}  // namespace
+
+TEST(FightJournalTest, EncodeDecodeRoundTrips) {
+  constexpr std::uint64_t kFirstTick = (std::uint64_t{1} << 40) + 5;
+  const lab7::CombatOutcome outcomes[] = {
+      lab7::CombatOutcome::Skipped, lab7::CombatOutcome::NoWinner,
+      lab7::CombatOutcome::AttackerWon, lab7::CombatOutcome::DefenderWon};
+  for (const lab7::CombatOutcome outcome : outcomes) {
+    for (const std::uint64_t offset : {std::uint64_t{0}, std::uint64_t{UINT32_MAX}}) {
+      const lab7::FightRecord fight = MakeFight(kFirstTick + offset, UINT32_MAX - 1, 7, outcome);
+      const lab7::JournalRecord encoded = lab7::FightJournal::Encode(fight, kFirstTick);
+      ExpectSameFight(fight, lab7::FightJournal::Decode(encoded, kFirstTick));
+    }
+  }
+}
+
+// An odd-sized roster is padded, so blocks and the index are read in place
+// at their natural alignment, whether found through the index or by a scan
+// of a journal that was never closed.
+TEST(FightJournalTest, FileRoundTripsWithAlignedBlocks) {
+  lab7::World world;
+  world.SetSeed(5);
+  for (int i = 0; i < 5; ++i) {
+    world.Add(static_cast<lab7::NpcType>(i % 3 + 1), i, i);
+  }
+  world.Kill(4);
+  std::vector<lab7::FightRecord> fights;
+  for (std::uint64_t i = 0; i < 7; ++i) {
+    fights.push_back(MakeFight(10 + i, static_cast<lab7::EntityId>(i % 4),
+                               static_cast<lab7::EntityId>((i + 1) % 4),
+                               i == 2 ? lab7::CombatOutcome::AttackerWon
+                                      : lab7::CombatOutcome::NoWinner));
+  }
+
+  const std::string path = TempPath("fight_journal_test.bin");
+  lab7::FightJournalWriter writer(path, world, 10, 3);
+  writer.Append(fights);
+  for (const bool closed : {false, true}) {
+    SCOPED_TRACE(closed);
+    if (closed) {
+      writer.Close();
+    } else {
+      writer.Flush();
+    }
+
+    const lab7::FightJournal journal(path);
+    EXPECT_EQ(journal.IsIndexed(), closed);
+    EXPECT_EQ(journal.GetSeed(), 5U);
+    EXPECT_EQ(journal.GetStartTick(), 10U);
+    ASSERT_EQ(journal.Roster().size(), 5U);
+    EXPECT_EQ(journal.Roster()[4] & lab7::FightJournal::kAliveBit, 0);
+    ASSERT_EQ(journal.Blocks().size(), 3U);
+    for (const lab7::JournalIndexEntry& entry : journal.Blocks()) {
+      EXPECT_EQ(entry.offset % alignof(lab7::JournalIndexEntry), 0U);
+      const auto address = reinterpret_cast<std::uintptr_t>(journal.Records(entry).data());
+      EXPECT_EQ(address % alignof(lab7::JournalRecord), 0U);
+    }
+
+    std::vector<lab7::FightRecord> read;
+    journal.ForEach(lab7::JournalFilter{},
+                    [&read](const lab7::FightRecord& fight) { read.push_back(fight); });
+    ASSERT_EQ(read.size(), fights.size());
+    for (std::size_t i = 0; i < fights.size(); ++i) {
+      ExpectSameFight(fights[i], read[i]);
+    }
+    const std::vector<bool> alive = journal.ReplayAlive(UINT64_MAX);
+    EXPECT_EQ(alive, (std::vector<bool>{true, true, true, false, false}));
+  }
+  std::remove(path.c_str());
+}
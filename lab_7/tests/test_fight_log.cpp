@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "fight_log.hpp"
+
+namespace {
+
+lab7::FightRecord MakeFight(lab7::CombatOutcome outcome) {
+  return lab7::FightRecord{1, 1, 2, lab7::NpcType::Bear, lab7::NpcType::Elf, outcome, {}};
+}
+
+}  // namespace
+
+TEST(FightLogTest, FormatsOnlyKillsAsMurders) {
+  std::ostringstream out;
+  {
+    lab7::AsyncFightLog log(out, nullptr, std::chrono::milliseconds(1000));
+    log.Push(MakeFight(lab7::CombatOutcome::AttackerWon));
+    log.Push(MakeFight(lab7::CombatOutcome::DefenderWon));
+    log.Push(MakeFight(lab7::CombatOutcome::NoWinner));
+    log.Push(MakeFight(lab7::CombatOutcome::Skipped));
+    log.Flush();
+    EXPECT_EQ(log.GetWritten(), 4u);
+  }
+  EXPECT_EQ(out.str(),
+            "MURDER: Bear \"#1\" killed Elf \"#2\"\n"
+            "MURDER: Elf \"#2\" killed Bear \"#1\"\n"
+            "FIGHT: Bear \"#1\" vs Elf \"#2\": no winner\n"
+            "FIGHT: Bear \"#1\" vs Elf \"#2\": skipped\n");
+}
@@ -0,0 +1,25 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <thread>
+
+#include "metrics.hpp"
+#include "thread_local_cache.hpp"
+
+TEST(MetricsTest, ShardPerThreadSurvivesManyRegistries) {
+  lab7::MetricsRegistry long_lived;
+  auto record = [&long_lived] {
+    for (std::size_t i = 0; i < 4 * lab7::kThreadLocalCacheLimit; ++i) {
+      long_lived.Local().Add(lab7::Counter::Kills);
+      lab7::MetricsRegistry short_lived;
+      short_lived.Local().Add(lab7::Counter::Kills);
+      EXPECT_EQ(short_lived.GetShardCount(), 1u);
+    }
+  };
+
+  record();
+  std::thread other(record);
+  other.join();
+  EXPECT_EQ(long_lived.GetShardCount(), 2u);
+  EXPECT_EQ(long_lived.Snapshot().Get(lab7::Counter::Kills), 8 * lab7::kThreadLocalCacheLimit);
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "scheduler.hpp"
+
+// A worker sleeps until the only pending deadline; setting the event
+// resumes the waiter, which erases that timer while the worker may still
+// be waiting on it. Later timers must still fire.
+TEST(SchedulerTest, CancelsPendingTimerWhileWorkerSleepsOnIt) {
+  using namespace std::chrono_literals;
+  lab7::Scheduler scheduler(1);
+  lab7::AsyncEvent event(scheduler);
+  lab7::AsyncEvent never(scheduler);
+  lab7::TaskGroup group;
+  std::atomic<bool> sleeping{false};
+  std::atomic<bool> was_set{false};
+  std::atomic<bool> timed_out{false};
+
+  auto wait_for_event = [&]() -> lab7::Task {
+    sleeping = true;
+    was_set = co_await event.WaitUntil(lab7::Scheduler::Clock::now() + 1h);
+    timed_out = !co_await never.WaitUntil(lab7::Scheduler::Clock::now() + 10ms);
+  };
+  scheduler.Spawn(wait_for_event(), group);
+  while (!sleeping) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(20ms);
+
+  const auto start = std::chrono::steady_clock::now();
+  event.Set();
+  scheduler.RunUntilDone(group);
+  EXPECT_TRUE(was_set);
+  EXPECT_TRUE(timed_out);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "map_bounds.hpp"
+#include "sparse_grid.hpp"
+#include "spatial_grid.hpp"
+
+namespace {
+
+struct Points {
+  std::vector<int> xs;
+  std::vector<int> ys;
+
+  void AddSquare(std::mt19937& gen, int count, int min, int max) {
+    std::uniform_int_distribution<> coord(min, max);
+    for (int i = 0; i < count; ++i) {
+      xs.push_back(coord(gen));
+      ys.push_back(coord(gen));
+    }
+  }
+};
+
+template <typename Grid>
+std::vector<std::size_t> Collect(const Grid& grid, int x, int y, int radius) {
+  std::vector<std::size_t> found;
+  grid.ForEachInRadius(x, y, radius, [&found](std::size_t j) { found.push_back(j); });
+  std::sort(found.begin(), found.end());
+  return found;
+}
+
+std::vector<std::size_t> BruteForce(const Points& points, int x, int y, int radius) {
+  std::vector<std::size_t> found;
+  const std::int64_t radius_sq = static_cast<std::int64_t>(radius) * radius;
+  for (std::size_t j = 0; j < points.xs.size(); ++j) {
+    const std::int64_t dx = static_cast<std::int64_t>(points.xs[j]) - x;
+    const std::int64_t dy = static_cast<std::int64_t>(points.ys[j]) - y;
+    if (dx * dx + dy * dy <= radius_sq) found.push_back(j);
+  }
+  return found;
+}
+
+// Queries every point with each radius; both grids must find exactly the
+// points a brute-force int64 scan finds.
+void ExpectSameResults(const Points& points, int map_size, int cell_size,
+                       std::initializer_list<int> radii) {
+  lab7::SpatialGrid dense(map_size, cell_size);
+  lab7::SparseGrid sparse(cell_size);
+  dense.Build(points.xs, points.ys);
+  sparse.Build(points.xs, points.ys);
+  for (std::size_t i = 0; i < points.xs.size(); ++i) {
+    for (const int radius : radii) {
+      const auto expected = BruteForce(points, points.xs[i], points.ys[i], radius);
+      ASSERT_EQ(Collect(dense, points.xs[i], points.ys[i], radius), expected)
+          << "dense, point " << i << ", radius " << radius;
+      ASSERT_EQ(Collect(sparse, points.xs[i], points.ys[i], radius), expected)
+          << "sparse, point " << i << ", radius " << radius;
+    }
+  }
+}
+
+// Entries a query of every point scans: those in the cells its radius
+// overlaps, hits or not.
+std::size_t CountCandidates(const lab7::SparseGrid& grid, const Points& points, int radius) {
+  const int cell = grid.GetCellSize();
+  std::size_t candidates = 0;
+  for (std::size_t i = 0; i < points.xs.size(); ++i) {
+    for (std::size_t j = 0; j < points.xs.size(); ++j) {
+      const int cx = points.xs[j] / cell;
+      const int cy = points.ys[j] / cell;
+      if (cx >= (points.xs[i] - radius) / cell && cx <= (points.xs[i] + radius) / cell &&
+          cy >= (points.ys[i] - radius) / cell && cy <= (points.ys[i] + radius) / cell) {
+        ++candidates;
+      }
+    }
+  }
+  return candidates;
+}
+
+}  // namespace
+
+TEST(SpatialGridTest, SparseGridMatchesDenseGrid) {
+  std::mt19937 gen(7);
+  Points points;
+  points.AddSquare(gen, 1500, 0, 1000);
+  // A crowd long enough for grid rows to take the distance kernel.
+  points.AddSquare(gen, 300, 400, 440);
+  ExpectSameResults(points, 1000, 10, {10, 50});
+}
+
+// Differences and squared distances of coordinates near 2^30 overflow
+// int32; radii above the kernel's int16 range take the scalar path.
+TEST(SpatialGridTest, SparseGridMatchesDenseGridNearCoordinateCap) {
+  constexpr int kCap = lab7::MapBounds::kMaxSize;
+  std::mt19937 gen(11);
+  Points points;
+  points.AddSquare(gen, 400, kCap - (1 << 21), kCap);
+  points.AddSquare(gen, 200, kCap - 60, kCap);
+  points.AddSquare(gen, 100, 0, 1 << 21);
+  points.AddSquare(gen, 100, 0, kCap);
+  points.xs.push_back(kCap);
+  points.ys.push_back(0);
+  points.xs.push_back(0);
+  points.ys.push_back(kCap);
+  ExpectSameResults(points, kCap, 1 << 22, {50, 40000, 1 << 20});
+}
+
+// The bounding box of a crowd plus one far-off entry asks for cells wider
+// than the crowd; Build() must shrink them or every query scans everyone.
+TEST(SpatialGridTest, SparseGridKeepsSmallCellsForClusters) {
+  constexpr int kCellSize = 50;
+  std::mt19937 gen(13);
+  Points points;
+  points.AddSquare(gen, 2000, 1000, 1500);
+  points.xs.push_back(1000000);
+  points.ys.push_back(1000000);
+
+  lab7::SparseGrid grid(kCellSize);
+  grid.Build(points.xs, points.ys);
+  EXPECT_EQ(grid.GetCellSize(), kCellSize);
+  EXPECT_LT(CountCandidates(grid, points, kCellSize), points.xs.size() * 200);
+  for (std::size_t i = 0; i < points.xs.size(); ++i) {
+    ASSERT_EQ(Collect(grid, points.xs[i], points.ys[i], kCellSize),
+              BruteForce(points, points.xs[i], points.ys[i], kCellSize))
+        << "point " << i;
+  }
+}
@@ -0,0 +1,32 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+
+#include "thread_pool.hpp"
+
+// A chunk that throws, on a worker or on the caller, is reported to the
+// caller after every other chunk has run, and the pool stays usable.
+TEST(ThreadPoolTest, ParallelForRethrowsAfterAllChunks) {
+  lab7::ThreadPool pool(4);
+  const std::size_t chunks = pool.GetChunkCount(1000, 1);
+  ASSERT_GT(chunks, 1U);
+
+  for (std::size_t failing = 0; failing < chunks; ++failing) {
+    std::atomic<std::size_t> done{0};
+    EXPECT_THROW(pool.ParallelFor(1000, 1,
+                                  [&](std::size_t chunk, std::size_t, std::size_t) {
+                                    if (chunk == failing) throw std::runtime_error("chunk");
+                                    done.fetch_add(1);
+                                  }),
+                 std::runtime_error);
+    EXPECT_EQ(done.load(), chunks - 1);
+  }
+
+  std::atomic<std::size_t> covered{0};
+  pool.ParallelFor(1000, 1, [&](std::size_t, std::size_t begin, std::size_t end) {
+    covered.fetch_add(end - begin);
+  });
+  EXPECT_EQ(covered.load(), 1000U);
+}